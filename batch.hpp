@@ -0,0 +1,319 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdio>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <filesystem>
+#include <charconv>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include "check.hpp"
+#include "thread_pool.hpp"
+#include "log_capture.hpp"
+#include "results.hpp"
+#include "profile.hpp"
+#include "shard.hpp"
+#include "journal.hpp"
+
+// summary.csv の 1 行
+// (ファイル名, ステータス, 縮約サイズ, "+" 区切りの縮約辺の id)
+struct SummaryEntry {
+    std::string filename;
+    std::string status;
+    std::vector<int> edgeids;
+    // 縮約辺の id が読めなかったときの理由 (読めたら空、空でなければチェックせずに失敗とする)
+    std::string error;
+};
+
+// CSV の 1 行をフィールドに分割する。"..." で囲まれたフィールドの中の , は区切りとみなさない。
+inline std::vector<std::string> splitCsvLine(const std::string &line) {
+    std::vector<std::string> fields;
+    std::string field;
+    bool quoted = false;
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (c == ',' && !quoted) {
+            fields.push_back(field);
+            field.clear();
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+    fields.push_back(field);
+    return fields;
+}
+
+// "+" 区切りの縮約辺の id を読む。数でないものがあれば std::nullopt を返す。
+inline std::optional<std::vector<int>> parseEdgeIds(const std::string &text) {
+    std::vector<int> edgeids;
+    std::istringstream conts(text);
+    std::string id;
+    while (std::getline(conts, id, '+')) {
+        if (id.empty()) continue;
+        int value;
+        auto [end, ec] = std::from_chars(id.data(), id.data() + id.size(), value);
+        if (ec != std::errc() || end != id.data() + id.size() || value < 0) {
+            return std::nullopt;
+        }
+        edgeids.push_back(value);
+    }
+    return edgeids;
+}
+
+// summary.csv のステータスが "C" の行を読み込む。
+// (ヘッダの行などステータスが "C" でない行は読まない。縮約辺の id が読めない行は error を設定して残す)
+inline std::vector<SummaryEntry> readSummary(const std::string &filename) {
+    std::ifstream ifs(filename);
+    if (!ifs) {
+        spdlog::critical("Failed to open {} ", filename);
+        throw std::runtime_error("Failed to open" + filename);
+    }
+    std::vector<SummaryEntry> entries;
+    std::string line;
+    for (int line_number = 1;std::getline(ifs, line); line_number++) {
+        std::vector<std::string> fields = splitCsvLine(line);
+        if (fields.size() < 4 || fields[1] != "C") continue;
+        std::optional<std::vector<int>> edgeids = parseEdgeIds(fields[3]);
+        if (!edgeids) {
+            entries.push_back({fields[0], fields[1], {},
+                               fmt::format("invalid contraction edge ids \"{}\" at {}:{}", fields[3], filename,
+                                           line_number)});
+            continue;
+        }
+        entries.push_back({fields[0], fields[1], std::move(*edgeids), ""});
+    }
+    return entries;
+}
+
+// confdir にある summary の entry の configuration ファイルのパス
+// (checkall.sh と同様に拡張子を .conf に置き換える)
+inline std::string confPath(const std::string &confdir, const SummaryEntry &entry) {
+    std::string name = entry.filename.substr(entry.filename.find_last_of('/') + 1);
+    name = name.substr(0, name.find_last_of('.'));
+    return confdir + "/" + name + ".conf";
+}
+
+// バッチ実行の設定
+struct BatchOptions {
+    std::string confdir;
+    std::string summary;
+    // 並列に処理する configuration の数
+    int jobs = 1;
+    // 1 つの configuration の中の計算を分割するタスクの数 (同じスレッドプールで実行する)
+    int inner_jobs = 1;
+    // 前計算の結果を保存するディレクトリ (空なら保存しない)
+    std::string cache_dir;
+    // 危険なケースを JSON Lines で書き出すファイル (空なら書き出さない)
+    std::string results;
+    // configuration ごとの計測結果を JSON で書き出すファイル (空なら計測しない)
+    std::string profile;
+    // configuration ごとのログを出力するか (false なら捨てる)
+    bool write_log = true;
+    // summary の configuration のうちチェックする shard
+    Shard shard;
+    // チェックし終えた configuration を記録するジャーナル (空なら記録しない)
+    std::string journal;
+    // ジャーナルにある configuration を飛ばして続きからチェックするか
+    bool resume = false;
+    // 各 configuration で全ての危険なケースを調べるか、最初の危険なケースで止めるか
+    StopPolicy stop_policy = StopPolicy::All;
+};
+
+// checkAll で configuration ごとに記録する結果
+struct BatchEntryResult {
+    std::string filename;
+    // 危険なケースの数 (読み込みに失敗したら -1)
+    int num_dangerous = 0;
+    // configuration を読み込んでからチェックし終えるまでの時間
+    uint64_t nanoseconds = 0;
+    std::vector<Finding> findings;
+};
+
+// 並列に処理した結果を summary の順番に出力する。
+class OrderedOutput {
+  private:
+    std::mutex mutex_;
+    std::vector<std::string> texts_;
+    std::vector<bool> done_;
+    size_t next_ = 0;
+    bool enabled_;
+
+  public:
+    // enabled が false なら出力せずに捨てる。
+    explicit OrderedOutput(size_t size, bool enabled = true) : texts_(size), done_(size, false), enabled_(enabled) {}
+
+    // index 番目の結果を設定し、そこまでの結果が揃っていれば出力する。
+    void set(size_t index, std::string text) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        texts_[index] = std::move(text);
+        done_[index] = true;
+        while (next_ < done_.size() && done_[next_]) {
+            if (enabled_) std::fwrite(texts_[next_].data(), 1, texts_[next_].size(), stdout);
+            texts_[next_].clear();
+            texts_[next_].shrink_to_fit();
+            next_++;
+        }
+        std::fflush(stdout);
+    }
+};
+
+// summary のステータスが "C" の configuration を全てチェックする。(options.shard があればそのうちの 1 つ)
+// configuration ごとのログは溜めておき、summary の順番に出力する。
+// 読み込みに失敗した configuration の数を返す。
+// entry_results が nullptr でなければ configuration ごとの結果を summary の順番に入れる。
+inline int checkAll(const BatchOptions &options, std::vector<BatchEntryResult> *entry_results = nullptr) {
+    std::vector<SummaryEntry> entries = readSummary(options.summary);
+    if (options.shard.count > 1) {
+        std::vector<double> costs;
+        for (const SummaryEntry &entry : entries) {
+            costs.push_back(confCost(confPath(options.confdir, entry)));
+        }
+        std::vector<SummaryEntry> selected;
+        for (size_t i : shardIndices(costs, options.shard)) {
+            selected.push_back(entries[i]);
+        }
+        spdlog::info("shard {}/{}: {} of {} configurations", options.shard.index, options.shard.count, selected.size(),
+                     entries.size());
+        entries = std::move(selected);
+    }
+
+    if (options.resume && options.journal.empty()) {
+        spdlog::critical("--resume needs --journal");
+        throw std::runtime_error("--resume needs --journal");
+    }
+
+    // 終わる前のマニフェストが残っていると、途中で止まったときに終わったように見えるので消しておく。
+    if (!options.results.empty()) {
+        std::filesystem::remove(manifestPath(options.results));
+    }
+    std::atomic<int> num_dangerous = 0, num_failed = 0;
+    // configuration ごとの危険なケースの数 (読み込みに失敗したら -1)
+    std::vector<int> verdicts(entries.size(), -1);
+    ProfileReport report(options.profile.empty() ? 0 : entries.size());
+    if (report.size() > 0) {
+        report.open(options.profile);
+        // configuration の中のタスクは他の configuration と同じスレッドプールで実行する。
+        report.setIncludesHelpedTasks(options.inner_jobs > 1);
+    }
+    if (entry_results) {
+        entry_results->assign(entries.size(), BatchEntryResult());
+    }
+    {
+        // 結果は summary の順番に書き出す。(各 index で results か journal に 1 度だけ書く)
+        // ジャーナルを書くときは危険なケースもジャーナルと一緒に書き出す。
+        std::unique_ptr<Journal> journal;
+        std::unique_ptr<ResultWriter> results;
+        if (!options.journal.empty()) {
+            journal = std::make_unique<Journal>(options.journal, options.results, options.resume,
+                                                stopPolicyName(options.stop_policy), entries.size());
+            if (options.resume) {
+                spdlog::info("resume: {} configurations in the journal {}", journal->numDone(), options.journal);
+            }
+        } else if (!options.results.empty()) {
+            results = std::make_unique<ResultWriter>(options.results, entries.size());
+        }
+        CaptureLogger capture_logger;
+        OrderedOutput output(entries.size(), options.write_log);
+        ThreadPool pool(options.jobs);
+        TaskGroup group(&pool);
+        for (size_t i = 0;i < entries.size(); i++) {
+            group.run([&, i] {
+                LogCapture capture(capture_logger.sink());
+                std::string filename = confPath(options.confdir, entries[i]);
+                BatchEntryResult *entry_result = entry_results ? &(*entry_results)[i] : nullptr;
+                if (!entries[i].error.empty()) {
+                    spdlog::error("verdict: {} failed ({})", filename, entries[i].error);
+                    num_failed++;
+                    if (results) results->write(i, "");
+                    if (journal) journal->skip(i);
+                    if (entry_result) {
+                        entry_result->filename = filename;
+                        entry_result->num_dangerous = -1;
+                    }
+                    output.set(i, capture.take());
+                    return;
+                }
+                if (journal) {
+                    if (std::optional<int> n = journal->done(filename, entries[i].edgeids)) {
+                        verdicts[i] = *n;
+                        journal->skip(i);
+                        if (*n == 0) {
+                            spdlog::info("verdict: {} ok (in the journal)", filename);
+                        } else {
+                            spdlog::info("verdict: {} dangerous ({} cases, in the journal)", filename, *n);
+                            num_dangerous++;
+                        }
+                        output.set(i, capture.take());
+                        return;
+                    }
+                }
+                Profile profile;
+                auto start = std::chrono::steady_clock::now();
+                try {
+                    CheckResult result = check(filename, entries[i].edgeids, options.stop_policy,
+                                               Parallelism{&pool, options.inner_jobs}, options.cache_dir,
+                                               report.size() > 0 ? &profile : nullptr);
+                    int n = result.num_dangerous;
+                    verdicts[i] = n;
+                    std::vector<Finding> &findings = result.findings;
+                    if (results) {
+                        results->write(i, formatFindings(filename, findings));
+                    }
+                    if (journal) {
+                        journal->write(i, filename, entries[i].edgeids, n, formatFindings(filename, findings));
+                    }
+                    if (entry_result) {
+                        entry_result->num_dangerous = n;
+                        entry_result->findings = std::move(findings);
+                    }
+                    if (n == 0) {
+                        spdlog::info("verdict: {} ok", filename);
+                    } else if (result.stopped) {
+                        spdlog::info("verdict: {} dangerous (stopped at the first case)", filename);
+                        num_dangerous++;
+                    } else {
+                        spdlog::info("verdict: {} dangerous ({} cases)", filename, n);
+                        num_dangerous++;
+                    }
+                } catch (const std::exception &e) {
+                    spdlog::error("verdict: {} failed ({})", filename, e.what());
+                    num_failed++;
+                    if (results) results->write(i, "");
+                    if (journal) journal->skip(i);
+                    if (entry_result) entry_result->num_dangerous = -1;
+                }
+                if (entry_result) {
+                    entry_result->filename = filename;
+                    entry_result->nanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start).count();
+                }
+                if (report.size() > 0) {
+                    report.set(i, filename, profile.snapshot());
+                }
+                output.set(i, capture.take());
+            });
+        }
+        group.wait();
+    }
+    spdlog::info("checked {} configurations: {} dangerous, {} failed", entries.size(), num_dangerous.load(), num_failed.load());
+    if (!options.results.empty()) {
+        ShardManifest manifest{options.shard, {}};
+        for (size_t i = 0;i < entries.size(); i++) {
+            manifest.files.emplace_back(jsonEscape(confPath(options.confdir, entries[i])), verdicts[i]);
+        }
+        writeManifest(manifestPath(options.results), manifest);
+    }
+    if (report.size() > 0) {
+        report.log();
+        report.write();
+    }
+    return num_failed;
+}
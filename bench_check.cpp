@@ -0,0 +1,268 @@
+// Configuration の計算のマイクロベンチマーク
+//
+// ./bench_check [benchmark のオプション] [FILE.conf[:ID,ID,...] ...]
+//
+// 三角格子の a x b の平行四辺形を内部とする configuration (リングサイズ 2(a+b)+2, 頂点数 ab+2(a+b)+2) と、
+// 引数で指定した .conf (":" の後は縮約辺の id) について計測する。
+// 引数がなければ toroidal_configurations の torus00095.conf, torus00096.conf があればそれを使う。
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <utility>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+#include "check.hpp"
+#include "cut6.hpp"
+
+using std::string;
+using std::vector;
+using std::set;
+using std::map;
+using std::pair;
+
+namespace {
+
+// 三角格子の頂点
+using Cell = pair<int, int>;
+
+constexpr std::array<Cell, 6> directions = {{{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, -1}, {-1, 1}}};
+
+vector<Cell> latticeNeighbors(const Cell &c) {
+    vector<Cell> cells;
+    for (auto [dx, dy] : directions) {
+        cells.push_back({c.first + dx, c.second + dy});
+    }
+    return cells;
+}
+
+// 三角格子の a x b の平行四辺形を内部とし、その周りの頂点をリングとする configuration
+// (平行四辺形の周りの頂点は誘導サイクルになる)
+Configuration syntheticConfiguration(int a, int b) {
+    set<Cell> inside;
+    for (int x = 0;x < a; x++) {
+        for (int y = 0;y < b; y++) {
+            inside.insert({x, y});
+        }
+    }
+    set<Cell> around;
+    for (const Cell &c : inside) {
+        for (const Cell &d : latticeNeighbors(c)) {
+            if (!inside.count(d)) around.insert(d);
+        }
+    }
+    // リングの頂点を巡回順に並べる。(最初の頂点からは隣接するリングの頂点のうち最初に見つかった方へ進む)
+    vector<Cell> cells = {*around.begin()};
+    Cell prev = cells[0];
+    while (true) {
+        Cell cur = cells.back(), next = prev;
+        for (const Cell &d : latticeNeighbors(cur)) {
+            if (around.count(d) && d != prev) {
+                next = d;
+                break;
+            }
+        }
+        if (next == cells[0]) break;
+        prev = cur;
+        cells.push_back(next);
+    }
+    int r = (int)cells.size();
+    cells.insert(cells.end(), inside.begin(), inside.end());
+    int n = (int)cells.size();
+    map<Cell, int> index;
+    for (int v = 0;v < n; v++) {
+        index[cells[v]] = v;
+    }
+    vector<set<int>> VtoV(n);
+    for (int v = 0;v < n; v++) {
+        for (const Cell &d : latticeNeighbors(cells[v])) {
+            auto it = index.find(d);
+            if (it != index.end()) VtoV[v].insert(it->second);
+        }
+    }
+    return Configuration(n, r, VtoV);
+}
+
+// 計測に使う configuration と縮約辺 (双対グラフの辺の id)
+struct BenchConf {
+    string name;
+    std::function<Configuration(void)> load;
+    vector<int> edgeids;
+    // .conf ファイルのパス (ファイルから読むときだけ)
+    string path;
+};
+
+// 縮約辺を設定し、contract_ によらない表を計算した configuration
+Configuration prepared(const BenchConf &bench) {
+    Configuration conf = bench.load();
+    conf.setContract(edgeFromId(conf, bench.edgeids));
+    conf.precomputeTables();
+    return conf;
+}
+
+void setSize(benchmark::State &state, const Configuration &conf) {
+    state.counters["n"] = conf.n_;
+    state.counters["r"] = conf.r_;
+}
+
+void benchDistance(benchmark::State &state, const BenchConf &bench) {
+    Configuration conf = prepared(bench);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(conf.calcDistance(true));
+    }
+    setSize(state, conf);
+}
+
+void benchShortestPaths(benchmark::State &state, const BenchConf &bench) {
+    Configuration conf = prepared(bench);
+    for (auto _ : state) {
+        for (int s = 0;s < conf.r_; s++) {
+            benchmark::DoNotOptimize(conf.calcShortestPaths(s, true));
+        }
+    }
+    setSize(state, conf);
+}
+
+void benchAllPaths(benchmark::State &state, const BenchConf &bench) {
+    Configuration conf = prepared(bench);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(conf.calcAllPaths());
+    }
+    setSize(state, conf);
+}
+
+// リングの頂点の組ごとの最短路で分けられる頂点集合 (以前の componentIdEquivalence による連結成分の計算)
+void benchComponents(benchmark::State &state, const BenchConf &bench) {
+    Configuration conf = prepared(bench);
+    vector<Path> paths;
+    for (int p = 0;p < conf.r_; p++) {
+        for (int q = 0;q < conf.r_; q++) {
+            if (p != q) paths.push_back(conf.shortestPaths(p, q)[0]);
+        }
+    }
+    for (auto _ : state) {
+        for (Path path : paths) {
+            benchmark::DoNotOptimize(conf.componentMask(path));
+        }
+    }
+    setSize(state, conf);
+}
+
+void benchCutReduction(benchmark::State &state, const BenchConf &bench) {
+    Configuration conf = prepared(bench);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(conf.calcCutReduction());
+    }
+    setSize(state, conf);
+}
+
+// 2 回目以降は checkShortCycle などのメモと縮約後の最短路が計算済みの状態で計る。
+template <int CutSize>
+void benchReductableVertices(benchmark::State &state, const BenchConf &bench) {
+    Configuration conf = prepared(bench);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(conf.calcReductableVertices<CutSize>());
+    }
+    setSize(state, conf);
+}
+
+// 縮約辺を設定してからの checkCuts 全体 (contract_ によらない表は計算済み)
+void benchCheckCuts(benchmark::State &state, const BenchConf &bench) {
+    Configuration base = prepared(bench);
+    for (auto _ : state) {
+        Configuration conf = base;
+        conf.setContract(edgeFromId(conf, bench.edgeids));
+        benchmark::DoNotOptimize(checkCuts(conf, bench.name));
+    }
+    setSize(state, base);
+}
+
+// cut6_core の公開 API での Configuration::check (縮約前の表は fromFile で計算済み)
+void benchApiCheck(benchmark::State &state, const BenchConf &bench) {
+    cut6::Configuration conf = cut6::Configuration::fromFile(bench.path);
+    conf.setContraction(bench.edgeids);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(conf.check());
+    }
+    state.counters["n"] = conf.numVertices();
+    state.counters["r"] = conf.ringSize();
+}
+
+void registerBenchmarks(const BenchConf &bench) {
+    using Kernel = void (*)(benchmark::State &, const BenchConf &);
+    const vector<pair<string, Kernel>> kernels = {
+        {"distance", benchDistance},
+        {"shortest_paths", benchShortestPaths},
+        {"all_paths", benchAllPaths},
+        {"components", benchComponents},
+        {"cut_reduction", benchCutReduction},
+        {"reductable_vertices6", benchReductableVertices<6>},
+        {"reductable_vertices7", benchReductableVertices<7>},
+        {"check_cuts", benchCheckCuts},
+    };
+    for (const auto &[name, kernel] : kernels) {
+        benchmark::RegisterBenchmark((name + "/" + bench.name).c_str(), kernel, bench)->Unit(benchmark::kMicrosecond);
+    }
+    if (!bench.path.empty()) {
+        benchmark::RegisterBenchmark(("api_check/" + bench.name).c_str(), benchApiCheck, bench)
+            ->Unit(benchmark::kMicrosecond);
+    }
+}
+
+// "FILE.conf:ID,ID,..." を BenchConf にする。
+BenchConf confFromArgument(const string &argument) {
+    BenchConf bench;
+    size_t colon = argument.find(':');
+    string filename = argument.substr(0, colon);
+    bench.name = std::filesystem::path(filename).filename().string();
+    bench.load = [filename] { return Configuration::readConfFile(filename); };
+    bench.path = filename;
+    if (colon != string::npos) {
+        std::istringstream ids(argument.substr(colon + 1));
+        string id;
+        while (getline(ids, id, ',')) {
+            if (!id.empty()) bench.edgeids.push_back(std::stoi(id));
+        }
+    }
+    return bench;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    benchmark::Initialize(&argc, argv);
+    // 危険なケースのログは出さない。
+    spdlog::set_level(spdlog::level::warn);
+
+    // 平行四辺形の大きさ (縮約辺は内部の辺のうち id が最小の 2 本)
+    const vector<pair<int, int>> sizes = {{1, 2}, {2, 2}, {3, 2}, {3, 3}, {4, 3}, {4, 4}};
+    for (auto [a, b] : sizes) {
+        BenchConf bench;
+        bench.name = fmt::format("lattice_{}x{}", a, b);
+        bench.load = [a = a, b = b] { return syntheticConfiguration(a, b); };
+        int r = 2 * (a + b) + 2;
+        bench.edgeids = {r, r + 1};
+        registerBenchmarks(bench);
+    }
+
+    vector<string> arguments(argv + 1, argv + argc);
+    if (arguments.empty()) {
+        // README に載っている縮約
+        const string dir = string(BENCH_CONF_DIR) + "/toroidal_configurations/reducible/conf/";
+        for (string argument : {"torus00095.conf:12,16,19,22,24,25,35", "torus00096.conf:12,17,19,23,25,35"}) {
+            if (std::filesystem::exists(dir + argument.substr(0, argument.find(':')))) {
+                arguments.push_back(dir + argument);
+            }
+        }
+    }
+    for (const string &argument : arguments) {
+        registerBenchmarks(confFromArgument(argument));
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,233 @@
+// バッチ実行 (checkAll) 全体のベンチマークと、危険なケースの回帰チェック
+//
+// ./bench_suite --summary SUMMARY --confdir DIR [--golden FILE] [--golden-dangerous FILE] [--update-golden]
+//
+// configuration の数/秒, configuration ごとの時間の p50/p99, 最大 RSS, メモリ確保の回数を出力する。
+// --golden を指定すると、見つかった危険なケースを (重複も含めて) FILE と比べて、異なれば失敗する。
+// --golden-dangerous を指定すると、危険なケースがある configuration のファイル名を FILE と比べて、異なれば失敗する。
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <new>
+#include <cmath>
+#include <sstream>
+#include <iterator>
+#include <cstdlib>
+#include <filesystem>
+#include <algorithm>
+#include <sys/resource.h>
+#include <boost/program_options.hpp>
+#include <spdlog/spdlog.h>
+#include "batch.hpp"
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// operator new の呼び出しの回数と確保したバイト数
+std::atomic<uint64_t> num_allocations = 0;
+std::atomic<uint64_t> allocated_bytes = 0;
+
+void *countedAllocate(size_t size) {
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void *operator new(size_t size) {
+    return countedAllocate(size);
+}
+
+void *operator new[](size_t size) {
+    return countedAllocate(size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// 昇順に並んだ values の q 分位点 (nearest-rank)
+uint64_t percentile(const vector<uint64_t> &values, double q) {
+    if (values.empty()) return 0;
+    size_t rank = (size_t)std::ceil(q * (double)values.size());
+    return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+}
+
+double milliseconds(uint64_t nanoseconds) {
+    return (double)nanoseconds / 1e6;
+}
+
+// ファイル名は confdir によらないように、ディレクトリを除いたものにする。
+string baseName(const string &filename) {
+    return std::filesystem::path(filename).filename().string();
+}
+
+// 危険なケースを 1 件 1 行の JSON にしたものを並べたもの (重複は残す)
+vector<string> findingLines(const vector<BatchEntryResult> &entry_results) {
+    vector<string> lines;
+    for (const BatchEntryResult &entry : entry_results) {
+        std::istringstream text(formatFindings(baseName(entry.filename), entry.findings));
+        string line;
+        while (getline(text, line)) {
+            lines.push_back(line);
+        }
+    }
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+// 危険なケースがある configuration のファイル名を並べたもの
+vector<string> dangerousLines(const vector<BatchEntryResult> &entry_results) {
+    vector<string> lines;
+    for (const BatchEntryResult &entry : entry_results) {
+        if (entry.num_dangerous > 0) lines.push_back(baseName(entry.filename));
+    }
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+vector<string> readGolden(const string &filename) {
+    std::ifstream ifs(filename);
+    if (!ifs) {
+        spdlog::critical("Failed to open {} ", filename);
+        throw std::runtime_error("Failed to open " + filename);
+    }
+    vector<string> lines;
+    string line;
+    while (getline(ifs, line)) {
+        if (!line.empty()) lines.push_back(line);
+    }
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+void writeGolden(const string &filename, const vector<string> &lines) {
+    std::ofstream ofs(filename);
+    for (const string &line : lines) {
+        ofs << line << '\n';
+    }
+    if (!ofs) {
+        spdlog::critical("Failed to write {} ", filename);
+        throw std::runtime_error("Failed to write " + filename);
+    }
+}
+
+// 昇順の lines と golden の差 (重複の数も比べる) をログに出力して、一致したかを返す。
+bool compareGolden(const vector<string> &lines, const vector<string> &golden, const string &filename) {
+    vector<string> missing, unexpected;
+    std::set_difference(golden.begin(), golden.end(), lines.begin(), lines.end(), std::back_inserter(missing));
+    std::set_difference(lines.begin(), lines.end(), golden.begin(), golden.end(), std::back_inserter(unexpected));
+    for (const string &line : missing) {
+        spdlog::error("missing: {}", line);
+    }
+    for (const string &line : unexpected) {
+        spdlog::error("unexpected: {}", line);
+    }
+    if (missing.empty() && unexpected.empty()) {
+        spdlog::info("golden: {} lines match {}", lines.size(), filename);
+        return true;
+    }
+    spdlog::error("golden: {} missing and {} unexpected lines compared with {}", missing.size(), unexpected.size(),
+                  filename);
+    return false;
+}
+
+} // namespace
+
+int main(const int ac, const char* const* const av) {
+    using namespace boost::program_options;
+    options_description description("Options");
+    description.add_options()
+        ("summary,s", value<string>(), "A summary file (checks all configurations with status C)")
+        ("confdir,d", value<string>(), "The directory that contains configuration files")
+        ("golden", value<string>(), "A file of the expected dangerous cases (JSON Lines) to compare with")
+        ("golden-dangerous", value<string>(), "A file of the names of the configurations expected to have dangerous cases to compare with")
+        ("update-golden", "Write the --golden and --golden-dangerous files instead of comparing")
+        ("cache-dir", value<string>(), "A directory to keep the precomputed tables of configurations")
+        ("jobs,j", value<int>()->default_value((int)std::thread::hardware_concurrency()), "The number of configurations checked in parallel")
+        ("inner-jobs", value<int>()->default_value(1), "The number of tasks the computation of one configuration is split into")
+        ("log", "Write the log of each configuration (discarded by default)")
+        ("help,H", "Display options");
+
+    variables_map vm;
+    store(parse_command_line(ac, av, description), vm);
+    notify(vm);
+
+    if (vm.count("help") || !vm.count("summary") || !vm.count("confdir")) {
+        description.print(std::cout);
+        return vm.count("help") ? 0 : 1;
+    }
+
+    BatchOptions options;
+    options.summary = vm["summary"].as<string>();
+    options.confdir = vm["confdir"].as<string>();
+    options.jobs = vm["jobs"].as<int>();
+    options.inner_jobs = vm["inner-jobs"].as<int>();
+    if (vm.count("cache-dir")) {
+        options.cache_dir = vm["cache-dir"].as<string>();
+    }
+    options.write_log = vm.count("log") > 0;
+
+    vector<BatchEntryResult> entry_results;
+    uint64_t allocations_before = num_allocations.load(), bytes_before = allocated_bytes.load();
+    auto start = std::chrono::steady_clock::now();
+    int num_failed = checkAll(options, &entry_results);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t allocations = num_allocations.load() - allocations_before;
+    uint64_t bytes = allocated_bytes.load() - bytes_before;
+
+    vector<uint64_t> latencies;
+    for (const BatchEntryResult &entry : entry_results) {
+        latencies.push_back(entry.nanoseconds);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    spdlog::info("{} configurations in {:.3f} s ({:.1f} configurations/s, {} jobs)", entry_results.size(), seconds,
+                 seconds > 0 ? entry_results.size() / seconds : 0.0, options.jobs);
+    spdlog::info("latency: p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms", milliseconds(percentile(latencies, 0.5)),
+                 milliseconds(percentile(latencies, 0.99)), milliseconds(latencies.empty() ? 0 : latencies.back()));
+    spdlog::info("peak RSS: {:.1f} MiB", usage.ru_maxrss / 1024.0);
+    spdlog::info("allocations: {} ({:.1f} MiB, {:.1f} per configuration)", allocations, bytes / 1048576.0,
+                 entry_results.empty() ? 0.0 : (double)allocations / entry_results.size());
+
+    int rc = num_failed > 0 ? 1 : 0;
+    auto golden = [&](const string &option, const vector<string> &lines) {
+        if (!vm.count(option)) return;
+        string filename = vm[option].as<string>();
+        if (vm.count("update-golden")) {
+            writeGolden(filename, lines);
+            spdlog::info("golden: wrote {} lines to {}", lines.size(), filename);
+        } else if (!compareGolden(lines, readGolden(filename), filename)) {
+            rc = 1;
+        }
+    };
+    golden("golden", findingLines(entry_results));
+    golden("golden-dangerous", dangerousLines(entry_results));
+    return rc;
+}
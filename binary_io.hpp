@@ -0,0 +1,92 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+// 前計算した表を書き出すバイト列
+// 値はそのままのバイト表現で並べ、配列は要素数と 8 バイト境界に揃えた要素の列で表す。
+class BinaryWriter {
+  private:
+    std::string data_;
+
+    void align(void) {
+        data_.resize((data_.size() + 7) / 8 * 8, '\0');
+    }
+
+  public:
+    template <typename T>
+    void write(const T &value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        data_.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(std::span<const T> values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write<uint64_t>(values.size());
+        align();
+        data_.append(reinterpret_cast<const char *>(values.data()), values.size_bytes());
+        align();
+    }
+
+    const std::string &data(void) const {
+        return data_;
+    }
+};
+
+// BinaryWriter で書き出したバイト列を先頭から読む。
+// 配列は元のバイト列の上の span として返すので、mmap した領域をコピーせずに参照できる。
+// バイト列が途中で終わっていたら std::runtime_error を投げる。
+class BinaryReader {
+  private:
+    const uint8_t *data_;
+    size_t size_;
+    size_t pos_ = 0;
+
+    const uint8_t *take(size_t bytes) {
+        if (bytes > size_ - pos_) {
+            throw std::runtime_error("Truncated binary data");
+        }
+        const uint8_t *p = data_ + pos_;
+        pos_ += bytes;
+        return p;
+    }
+
+    void align(void) {
+        take((pos_ + 7) / 8 * 8 - pos_);
+    }
+
+  public:
+    BinaryReader(const void *data, size_t size) : data_(static_cast<const uint8_t *>(data)), size_(size) {}
+
+    template <typename T>
+    T read(void) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    // 先頭が T の境界に揃っている必要があるので、 T の大きさは 8 バイトの約数に限る。
+    template <typename T>
+    std::span<const T> readArray(void) {
+        static_assert(std::is_trivially_copyable_v<T> && 8 % alignof(T) == 0);
+        uint64_t size = read<uint64_t>();
+        align();
+        if (size > (size_ - pos_) / sizeof(T)) {
+            throw std::runtime_error("Truncated binary data");
+        }
+        const T *p = reinterpret_cast<const T *>(take(size * sizeof(T)));
+        align();
+        return std::span<const T>(p, size);
+    }
+
+    bool atEnd(void) const {
+        return pos_ == size_;
+    }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include "binary_io.hpp"
+
+// 行優先で連続した領域に格納した uint8_t の行列
+// m[i][j] で (i, j) 成分にアクセスする。
+// 各行の先頭が揃うように、行の長さを RowAlignment の倍数に切り上げて格納する。
+class ByteMatrix {
+  private:
+    static constexpr int RowAlignment = 16;
+
+    int rows_;
+    int cols_;
+    // 行の先頭の間隔
+    int stride_;
+    std::vector<uint8_t> data_;
+
+  public:
+    ByteMatrix() : rows_(0), cols_(0), stride_(0) {}
+
+    ByteMatrix(int rows, int cols, uint8_t value = 0) :
+        rows_(rows), cols_(cols), stride_((cols + RowAlignment - 1) / RowAlignment * RowAlignment),
+        data_((size_t)rows * stride_, value) {}
+
+    uint8_t *operator[](int i) {
+        return data_.data() + (size_t)i * stride_;
+    }
+
+    const uint8_t *operator[](int i) const {
+        return data_.data() + (size_t)i * stride_;
+    }
+
+    int rows(void) const {
+        return rows_;
+    }
+
+    int cols(void) const {
+        return cols_;
+    }
+
+    int stride(void) const {
+        return stride_;
+    }
+
+    bool operator==(const ByteMatrix &other) const = default;
+
+    void write(BinaryWriter &writer) const {
+        writer.write<int32_t>(rows_);
+        writer.write<int32_t>(cols_);
+        writer.writeArray<uint8_t>(data_);
+    }
+
+    static ByteMatrix read(BinaryReader &reader) {
+        int rows = reader.read<int32_t>();
+        int cols = reader.read<int32_t>();
+        std::span<const uint8_t> data = reader.readArray<uint8_t>();
+        if (rows < 0 || cols < 0) {
+            throw std::runtime_error("Invalid matrix size");
+        }
+        ByteMatrix m(rows, cols);
+        if (data.size() != m.data_.size()) {
+            throw std::runtime_error("Invalid matrix size");
+        }
+        m.data_.assign(data.begin(), data.end());
+        return m;
+    }
+};
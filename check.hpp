@@ -1,41 +1,78 @@
+#pragma once
+
 #include <string>
+#include <array>
 #include <vector>
 #include <fstream>
+#include <sstream>
+#include <optional>
 #include <utility>
 #include <map>
 #include <set>
+#include <tuple>
 #include <deque>
 #include <cassert>
 #include <numeric>
+#include <algorithm>
+#include <span>
 #include <spdlog/spdlog.h>
 #include <fmt/core.h>
+#include <fmt/format.h>
+#include "byte_matrix.hpp"
+#include "graph.hpp"
+#include "vertex_set.hpp"
+#include "lazy_table.hpp"
+#include "path_list.hpp"
+#include "thread_pool.hpp"
+#include "ring_tuple_index.hpp"
+#include "cut_pattern.hpp"
+#include "binary_io.hpp"
+#include "conf_cache.hpp"
+#include "results.hpp"
+#include "logging.hpp"
+#include "profile.hpp"
+
+// 到達できない頂点間の距離
+const uint8_t INF = 255;
+
+// forbidden_cut_size[l] := 長さ l (<= 7) のカットで分けられた部分の頂点の数がこれより多ければ矛盾する
+constexpr std::array<int, 8> forbidden_cut_size = {0, 0, 0, 0, 0, 1, 3, 4};
+
+// 長さ cutsize のカットで component_size 個の頂点が分けられることが矛盾するか
+constexpr bool isForbiddenCut(int cutsize, int component_size) {
+    return cutsize <= 7 && component_size > forbidden_cut_size[std::max(cutsize, 0)];
+}
+
+// 危険なケースが見つかったときにチェックを続けるか
+enum class StopPolicy {
+    // 全ての危険なケースを調べる。
+    All,
+    // 最初に見つかった危険なケースで止める。
+    FirstDanger,
+};
 
-using std::string;
-using std::vector;
-using std::set;
-using std::map;
-using std::pair;
-using std::tuple;
-using std::deque;
-using std::min;
-using std::max;
-using std::swap;
-
-const int INF = 10000;
-
-bool isForbiddenCut(int cutsize, int component_size) {
-    if (cutsize <= 4) {
-        return component_size > 0;
-    } else if (cutsize == 5) {
-        return component_size > 1;
-    } else if (cutsize == 6) {
-        return component_size > 3;
-    } else if (cutsize == 7) {
-        return component_size > 4;
-    }
-    return false;
+// ジャーナルなどに記録する policy の名前
+inline const char *stopPolicyName(StopPolicy policy) {
+    return policy == StopPolicy::FirstDanger ? "first_danger" : "all";
 }
 
+// check の結果
+struct CheckResult {
+    // 危険なケースの数 (StopPolicy::FirstDanger なら 0 か 1)
+    int num_dangerous = 0;
+    // StopPolicy::FirstDanger で危険なケースが見つかって途中で止めたか
+    bool stopped = false;
+    std::vector<Finding> findings;
+};
+
+// Configuration の中の計算を並列に行うための設定
+struct Parallelism {
+    // タスクを実行するスレッドプール (nullptr なら並列化しない)
+    ThreadPool *pool = nullptr;
+    // 1 つの計算を分割するタスクの数
+    int jobs = 1;
+};
+
 // pq-contractibly connected パス := 
 //     リングの頂点 p, q (p != q) を configuration の外側で繋ぐパス P であって、
 //     p < q のとき E = P + p{p+1} + ... {q-1}q
@@ -43,75 +80,124 @@ bool isForbiddenCut(int cutsize, int component_size) {
 //     が configuration と disjoint な disk を囲うようなもの。
 struct Configuration {
   private:
+    Parallelism parallelism_;
+    // 計測結果を加える先 (nullptr なら計測しない)
+    Profile *profile_ = nullptr;
     // 縮約辺
-    vector<pair<int, int>> contract_; 
-    // contract_ を縮約した結果 conf の中にできる 2,3-cut reduction によって削除される頂点集合
-    vector<bool> is_reductable_inside_;
-    // 6サイクルの中に conf があり、 contract_ を縮約した結果 conf の外にできる 2,3-cut reduction によって削除される頂点集合
-    vector<bool> is_reductable_outside6_;
-    // 7サイクルの中に conf があり、 contract_ を縮約した結果 conf の外にできる 2,3-cut reduction によって削除される頂点集合
-    vector<bool> is_reductable_outside7_;
+    std::vector<std::pair<int, int>> contract_; 
+    // 縮約辺だけからなるグラフ
+    Graph contracted_;
+    // reductable_[ReductableInside] := contract_ を縮約した結果 conf の中にできる 2,3-cut reduction によって削除される頂点集合
+    // reductable_[ReductableOutside6] := 6サイクルの中に conf があり、 contract_ を縮約した結果 conf の外にできる 2,3-cut reduction によって削除される頂点集合
+    // reductable_[ReductableOutside7] := 7サイクルの中に conf があり、 contract_ を縮約した結果 conf の外にできる 2,3-cut reduction によって削除される頂点集合
+    // (初めて参照したときに計算する。contract_ を変えたら破棄する。)
+    enum { ReductableInside, ReductableOutside6, ReductableOutside7, NumReductables };
+    LazyTable<std::vector<bool>> reductable_;
     // dist_contracted_[u][v] := contract_ を縮約した後の uv の間の最短距離
-    vector<vector<int>> dist_contracted_;
+    ByteMatrix dist_contracted_;
     // 縮約後の代表元 (同一視された頂点のうちインデックスが最小のもの) の計算
-    vector<int> representative_;
-    // length6_[p][q] := 6サイクルの中に conf があり、
-    // ring の頂点 p, q について pq-contractiblely connected パスがサイクルの一部であるときの最小の長さ。
-    vector<vector<int>> length6_;
-    // length_onedge6_[p][q] := 6サイクルの中に conf があり、
-    // ring の頂点 p, q について pq-contractiblely connected パスが 1 辺を除いてサイクルの一部であるときの最小の長さ。
-    vector<vector<int>> length_oneedge6_;
-    // length7_[p][q] := 7サイクルの中に conf があり、
+    std::vector<int> representative_;
+    // class_mask_[v] := contract_ を縮約した後に v と同じ頂点になる頂点の集合
+    std::vector<VertexSet> class_mask_;
+    // addContractEdge で辺を加える前の縮約後の状態 (最後に加えた辺から順に除くときに戻す、setContract で破棄する)
+    struct ContractState {
+        Graph contracted;
+        ByteMatrix dist_contracted;
+        std::vector<int> representative;
+        std::vector<VertexSet> class_mask;
+    };
+    std::vector<ContractState> contract_undo_;
+    // neighbor_mask_[v] := v の隣接頂点の集合
+    std::vector<VertexSet> neighbor_mask_;
+    // ring の頂点の集合
+    VertexSet ring_mask_;
+    // length_tables_[Length6][p][q] := 6サイクルの中に conf があり、
     // ring の頂点 p, q について pq-contractiblely connected パスがサイクルの一部であるときの最小の長さ。
-    vector<vector<int>> length7_;
-    // length_onedge7_[p][q] := 7サイクルの中に conf があり、
+    // length_tables_[LengthOneEdge6][p][q] := 6サイクルの中に conf があり、
     // ring の頂点 p, q について pq-contractiblely connected パスが 1 辺を除いてサイクルの一部であるときの最小の長さ。
-    vector<vector<int>> length_oneedge7_;
-    // all_paths_[p][q] := リングの頂点 p,q の間の長さ 7 以下の全てのパス
-    vector<vector<vector<vector<int>>>> all_paths_;
+    // length_tables_[Length7], length_tables_[LengthOneEdge7] := 7サイクルの中に conf があるときの同様の値
+    // (初めて参照したときに計算する。どれも contract_ によらない。)
+    enum { Length6, LengthOneEdge6, Length7, LengthOneEdge7, NumLengthTables };
+    LazyTable<ByteMatrix> length_tables_;
+    // shortest_paths_[p][q] := リングの頂点 p, q の間の最短路の集合 (shortestPaths(p, q, false) のキャッシュ)
+    LazyTable<std::vector<PathList>> shortest_paths_;
+    // contracted_shortest_paths_[p][q] := contract_ を縮約した後のリングの頂点 p, q の間の最短路の集合
+    // (shortestPaths(p, q, true) のキャッシュ、setContract で破棄する)
+    LazyTable<std::vector<PathList>> contracted_shortest_paths_;
+    // short_cycle_memo_, forbidden_cycle_memo_, forbidden_cycle_oneedge_memo_ := 
+    // checkShortCycle, forbiddenCycle, forbiddenCycleOneEdge の (a, b, k, cutSize) ごとの結果 (cycleMemoIndex の位置)
+    // どれも contract_ によらない。
+    LazyBitTable short_cycle_memo_;
+    LazyBitTable forbidden_cycle_memo_;
+    LazyBitTable forbidden_cycle_oneedge_memo_;
+    // all_paths_[0] のグループ p * r_ + q := リングの頂点 p,q の間の長さ 7 以下の全てのパス
+    // (初めて参照したときに計算する。contract_ によらない。)
+    LazyTable<PathStore> all_paths_;
+
+    // 縮約によらない部分だけを作る。dist_ は後から setDistance で設定する。
+    Configuration(int n, int r, Graph graph, Parallelism parallelism):
+        parallelism_(parallelism),
+        contract_({}), 
+        contracted_(n, {}),
+        reductable_(NumReductables),
+        length_tables_(NumLengthTables),
+        shortest_paths_(r),
+        contracted_shortest_paths_(r),
+        short_cycle_memo_(r * r * 16),
+        forbidden_cycle_memo_(r * r * 16),
+        forbidden_cycle_oneedge_memo_(r * r * 16),
+        all_paths_(1),
+        n_(n), r_(r), graph_(std::move(graph)) {
+        neighbor_mask_.assign(n_, VertexSet());
+        for (int v = 0;v < n_; v++) {
+            for (int u : graph_.neighbors(v)) {
+                neighbor_mask_[v].set(u);
+            }
+        }
+        ring_mask_ = VertexSet::range(r_);
+    }
+
+    void setDistance(ByteMatrix dist) {
+        dist_ = std::move(dist);
+        dist_contracted_ = dist_;
+        representative_ = calcRepresentative();
+        class_mask_ = calcClassMask();
+    }
   public:
     // 頂点数
     int n_; 
     // リングサイズ
     int r_;
-    // the free completion with its ring の隣接リスト
-    vector<set<int>> VtoV_;
+    // the free completion with its ring のグラフ
+    Graph graph_;
     // dist_[u][v] := uv の間の最短距離
-    vector<vector<int>> dist_;
+    ByteMatrix dist_;
 
-    Configuration(int n, int r, const vector<set<int>> &VtoV): 
-        contract_({}), 
-        is_reductable_inside_(vector<bool>(n, false)),
-        is_reductable_outside6_(vector<bool>(n, false)),
-        is_reductable_outside7_(vector<bool>(n, false)),
-        n_(n), r_(r), VtoV_(VtoV) {
-        dist_ = WF();
-        dist_contracted_ = dist_;
-        representative_ = calcRepresentative();
-        all_paths_.assign(r_, vector<vector<vector<int>>>(r_));
-        for (int p = 0;p < r_; p++) {
-            for (int q = 0;q < r_; q++) {
-                if (p == q) continue;
-                all_paths_[p][q] = calculatePaths(p, q);
-            }
-        }
-        length6_ = calcLowerBoundLengthOuterPath(6);
-        length7_ = calcLowerBoundLengthOuterPath(7);
-        length_oneedge6_ = calcLowerBoundLengthOuterPathOneEdge(6);
-        length_oneedge7_ = calcLowerBoundLengthOuterPathOneEdge(7);
+    Configuration(int n, int r, const std::vector<std::set<int>> &VtoV, Parallelism parallelism = {}): 
+        Configuration(n, r, Graph(VtoV), parallelism) {
+        setDistance(calcDistance());
     }
 
-    static Configuration readConfFile(const string &filename) {
+    static Configuration readConfFile(const std::string &filename, Parallelism parallelism = {}) {
         std::ifstream ifs(filename);
         if (!ifs) {
             spdlog::critical("Failed to open {} ", filename);
             throw std::runtime_error("Failed to open" + filename);
         }
-        string dummy;
+        return readConf(ifs, filename, parallelism);
+    }
+
+    // filename の内容 ifs を読み込む。
+    static Configuration readConf(std::istream &ifs, const std::string &filename, Parallelism parallelism = {}) {
+        std::string dummy;
         getline(ifs, dummy);
         int n, r;
         ifs >> n >> r;
-        vector<set<int>> VtoV(n);
+        if (!ifs || n > Graph::MAX_VERTICES || r > n) {
+            spdlog::critical("Invalid configuration size in {} ", filename);
+            throw std::runtime_error("Invalid configuration size in " + filename);
+        }
+        std::vector<std::set<int>> VtoV(n);
         for (int i = 0;i < r; i++) {
             VtoV[i].insert((i + 1) % r);
             VtoV[(i + 1) % r].insert(i);
@@ -131,31 +217,191 @@ struct Configuration {
                 }
             }
         }
-        return Configuration(n, r, VtoV);
+        return Configuration(n, r, VtoV, parallelism);
     }
 
-    // 縮約辺 contract_ を設定して、それに伴う更新をする。
-    void setContract(const vector<pair<int, int>> &contract) {
+    // 縮約辺 contract_ を設定して、縮約後の距離と代表元を更新する。
+    // 2,3-cut reduction で削除される頂点集合は破棄して、次に参照したときに計算し直す。
+    void setContract(const std::vector<std::pair<int, int>> &contract) {
         contract_ = contract;
-        dist_contracted_ = WF(true);
-        is_reductable_inside_ = calcCutReduction();
-        is_reductable_outside6_ = calcReductableVertices(6);
-        is_reductable_outside7_ = calcReductableVertices(7);
+        contracted_ = Graph(n_, contract_);
+        dist_contracted_ = calcDistance(true);
+        contracted_shortest_paths_.clear();
         representative_ = calcRepresentative();
+        class_mask_ = calcClassMask();
+        reductable_.clear();
+        contract_undo_.clear();
+        return;
+    }
+
+    // contract_ によらない表 (all_paths_ と 4 つの長さの表) を計算しておく。
+    // taskPool があれば 4 つの表を並列に計算する。
+    void precomputeTables(void) const {
+        allPaths();
+        // 4 つの表は互いに独立に計算できる。
+        TaskGroup group(taskPool());
+        group.run([&] { lowerBoundLength<6>(); });
+        group.run([&] { lowerBoundLength<7>(); });
+        group.run([&] { lowerBoundLengthOneEdge<6>(); });
+        group.run([&] { lowerBoundLengthOneEdge<7>(); });
+        group.wait();
+    }
+
+    // contract_ によらない前計算の結果 (グラフ, dist_, all_paths_ と 4 つの長さの表) を書き出す。
+    // まだ計算していない表はここで計算する。
+    void writeTables(BinaryWriter &writer) const {
+        precomputeTables();
+        writer.write<int32_t>(n_);
+        writer.write<int32_t>(r_);
+        graph_.write(writer);
+        dist_.write(writer);
+        allPaths().write(writer);
+        lowerBoundLength<6>().write(writer);
+        lowerBoundLengthOneEdge<6>().write(writer);
+        lowerBoundLength<7>().write(writer);
+        lowerBoundLengthOneEdge<7>().write(writer);
+    }
+
+    // writeTables で書き出したものから Configuration を作る。
+    // 形式が合わなければ std::runtime_error を投げる。
+    static Configuration readTables(BinaryReader &reader, Parallelism parallelism = {}) {
+        int n = reader.read<int32_t>();
+        int r = reader.read<int32_t>();
+        Graph graph = Graph::read(reader);
+        if (graph.size() != n || r < 0 || r > n) {
+            throw std::runtime_error("Invalid configuration size");
+        }
+        Configuration conf(n, r, std::move(graph), parallelism);
+        ByteMatrix dist = ByteMatrix::read(reader);
+        if (dist.rows() != n || dist.cols() != n) {
+            throw std::runtime_error("Invalid distance table");
+        }
+        conf.setDistance(std::move(dist));
+        PathStore all_paths = PathStore::read(reader);
+        if (all_paths.numGroups() != (size_t)r * r) {
+            throw std::runtime_error("Invalid path store");
+        }
+        conf.all_paths_.set(0, std::move(all_paths));
+        for (int table : {Length6, LengthOneEdge6, Length7, LengthOneEdge7}) {
+            ByteMatrix length = ByteMatrix::read(reader);
+            if (length.rows() != r || length.cols() != r) {
+                throw std::runtime_error("Invalid length table");
+            }
+            conf.length_tables_.set(table, std::move(length));
+        }
+        if (!reader.atEnd()) {
+            throw std::runtime_error("Trailing data");
+        }
+        return conf;
+    }
+
+    // 2,3-cut reduction によって削除される頂点集合を計算しておく。
+    // taskPool があれば 3 つの集合を並列に計算する。
+    void precomputeReductables(void) const {
+        // 3 つの計算は互いに独立に計算できる。
+        TaskGroup group(taskPool());
+        group.run([&] { isReductableInside(); });
+        group.run([&] { isReductableOutside<6>(); });
+        group.run([&] { isReductableOutside<7>(); });
+        group.wait();
+    }
+
+    // 縮約によって削除される頂点をログに出力する。
+    void logErasedVertices(void) const {
+        const std::vector<bool> &is_reductable_inside = isReductableInside();
+        const std::vector<bool> &is_reductable_outside6 = isReductableOutside<6>();
+        const std::vector<bool> &is_reductable_outside7 = isReductableOutside<7>();
         for (int v = 0;v < n_; v++) {
-            if (is_reductable_inside_[v] || is_reductable_outside6_[v]) {
-                spdlog::info("vertex {} is erased by 6", v);
+            if (is_reductable_inside[v] || is_reductable_outside6[v]) {
+                LOG_DIAGNOSTIC("vertex {} is erased by 6", v);
             }
-            if (is_reductable_inside_[v] || is_reductable_outside7_[v]) {
-                spdlog::info("vertex {} is erased by 7", v);
+            if (is_reductable_inside[v] || is_reductable_outside7[v]) {
+                LOG_DIAGNOSTIC("vertex {} is erased by 7", v);
+            }
+        }
+        return;
+    }
+
+    // 辺 uv を縮約辺に加える。
+    // 縮約後の距離は uv を通る経路だけ短くなるので O(n^2) で更新し、代表元は 2 つの頂点の同値類を併合する。
+    // 2,3-cut reduction で削除される頂点集合は破棄して、次に参照したときに計算し直す。
+    // 加える前の状態は removeContractEdge のために残しておく。
+    void addContractEdge(int u, int v) {
+        assert(u != v && graph_.adjacent(u, v));
+        contract_undo_.push_back({contracted_, dist_contracted_, representative_, class_mask_});
+        contract_.push_back({u, v});
+        contracted_ = Graph(n_, contract_);
+        // d(i, j) = min(d(i, j), d(i, u) + d(v, j), d(i, v) + d(u, j))
+        std::vector<uint8_t> du(dist_contracted_[u], dist_contracted_[u] + n_);
+        std::vector<uint8_t> dv(dist_contracted_[v], dist_contracted_[v] + n_);
+        for (int i = 0;i < n_; i++) {
+            uint8_t *d = dist_contracted_[i];
+            for (int j = 0;j < n_; j++) {
+                int via = std::min(du[i] + dv[j], dv[i] + du[j]);
+                if (via < d[j]) {
+                    d[j] = (uint8_t)via;
+                }
             }
         }
+        // 代表元はインデックスが最小のものなので、大きい方の同値類を小さい方に付け替える。
+        int ru = representative_[u], rv = representative_[v];
+        if (ru != rv) {
+            VertexSet merged = class_mask_[ru] | class_mask_[rv];
+            int root = std::min(ru, rv);
+            merged.forEach([&](int w) {
+                representative_[w] = root;
+                class_mask_[w] = merged;
+            });
+        }
+        contracted_shortest_paths_.clear();
+        reductable_.clear();
         return;
     }
 
-    vector<int> calcRepresentative(void) {
+    // 辺 uv を縮約辺から除く。
+    // uv が addContractEdge で最後に加えた辺なら加える前の状態に戻す。
+    // そうでなければ縮約後の距離と代表元は差分では更新できないので、残りの縮約辺から計算し直す。
+    void removeContractEdge(int u, int v) {
+        if (!contract_undo_.empty() &&
+            (contract_.back() == std::pair<int, int>(u, v) || contract_.back() == std::pair<int, int>(v, u))) {
+            ContractState &state = contract_undo_.back();
+            contracted_ = std::move(state.contracted);
+            dist_contracted_ = std::move(state.dist_contracted);
+            representative_ = std::move(state.representative);
+            class_mask_ = std::move(state.class_mask);
+            contract_undo_.pop_back();
+            contract_.pop_back();
+            contracted_shortest_paths_.clear();
+            reductable_.clear();
+            return;
+        }
+        auto it = std::find_if(contract_.begin(), contract_.end(), [&](const std::pair<int, int> &e) {
+            return (e.first == u && e.second == v) || (e.first == v && e.second == u);
+        });
+        assert(it != contract_.end());
+        std::vector<std::pair<int, int>> contract = contract_;
+        contract.erase(contract.begin() + (it - contract_.begin()));
+        setContract(contract);
+        return;
+    }
+
+    // 計測結果を profile に加えるようにする。(nullptr なら計測しない)
+    void setProfile(Profile *profile) {
+        profile_ = profile;
+    }
+
+    Profile *profile(void) const {
+        return profile_;
+    }
+
+    // 互いに独立な計算をタスクとして並列に実行するスレッドプール (並列化しないなら nullptr)
+    ThreadPool *taskPool(void) const {
+        return parallelism_.jobs > 1 ? parallelism_.pool : nullptr;
+    }
+
+    std::vector<int> calcRepresentative(void) {
         // 縮約後の代表元の計算 (代表元はインデックスが最小のものを選ぶようにしている)
-        vector<int> representative(n_, -1);
+        std::vector<int> representative(n_, -1);
         for (int v = 0;v < n_; v++) {
             for (int u = 0;u < n_; u++) {
                 if (equivalent(v, u)) {
@@ -167,94 +413,116 @@ struct Configuration {
         return representative;
     }
 
+    // representative_ から各頂点と同じ頂点になる頂点の集合を計算する。
+    std::vector<VertexSet> calcClassMask(void) const {
+        std::vector<VertexSet> class_mask(n_);
+        for (int v = 0;v < n_; v++) {
+            class_mask[representative_[v]].set(v);
+        }
+        for (int v = 0;v < n_; v++) {
+            class_mask[v] = class_mask[representative_[v]];
+        }
+        return class_mask;
+    }
+
     // contract_ の辺を縮約した後に同じ頂点になっているかどうかを計算する。
     bool equivalent(int u, int v) const {
         return dist_contracted_[v][u] == 0;
     }
 
-    // APSP Warshall-Floyd
-    // after_contract = true なら contract_ に含まれる辺を縮約した場合の距離を返す。
-    vector<vector<int>> WF(bool after_contract=false) const {
-        vector<vector<int>> dist(n_, vector<int>(n_, INF));
-        for (int v = 0;v < n_; v++) {
-            dist[v][v] = 0;
-            for (int u : VtoV_[v]) {
-                dist[v][u] = 1;
-            }
-        }
-        if (after_contract) {
-            for (const auto &e : contract_) {
-                assert(dist[e.first][e.second] == 1);
-                dist[e.first][e.second] = 0;
-                dist[e.second][e.first] = 0;
-            }
-        }
-        for (int k = 0;k < n_; k++) {
-            for (int i = 0;i < n_; i++) {
-                for (int j = 0;j < n_; j++) {
-                    dist[i][j] = min(dist[i][j], dist[i][k] + dist[k][j]);
-                }
-            }
-        }
-        return dist;
+    // contract_ を縮約した後の距離
+    const ByteMatrix &contractedDistance(void) const {
+        return dist_contracted_;
     }
 
-    // s-t shortestPaths の列挙
-    // after_contract = true ならば contract に含まれる辺を縮約した場合の最短路を考える。
-    vector<vector<int>> shortestPaths(int s, int t, bool after_contract=false) const {
-        set<pair<int, int>> contract_set;
-        if (after_contract) {
-            for (const auto &e : contract_) {
-                contract_set.insert(e);
-                contract_set.insert({e.second, e.first});
-            }
-        }
-        vector<int> dist(n_, INF);
-        dist[s] = 0;
-        deque<int> que;
-        que.push_back(s);
-        while (!que.empty()) {
-            int v = que.front();
-            que.pop_front();
-            for (int u : VtoV_[v]) {
-                if (contract_set.count({u, v})) {
-                    if (dist[v] < dist[u]) {
-                        dist[u] = dist[v];
-                        que.push_front(u);
+    // APSP (各頂点からの 0-1 BFS)
+    // after_contract = true なら contract_ に含まれる辺を縮約した場合の距離を返す。
+    ByteMatrix calcDistance(bool after_contract=false) const {
+        for ([[maybe_unused]] const auto &e : contract_) {
+            assert(e.first != e.second && graph_.adjacent(e.first, e.second));
+        }
+        ByteMatrix dist(n_, n_, INF);
+        std::deque<int> que;
+        for (int s = 0;s < n_; s++) {
+            uint8_t *d = dist[s];
+            d[s] = 0;
+            que.push_back(s);
+            while (!que.empty()) {
+                int v = que.front();
+                que.pop_front();
+                if (after_contract) {
+                    for (int u : contracted_.neighbors(v)) {
+                        if (d[v] < d[u]) {
+                            d[u] = d[v];
+                            que.push_front(u);
+                        }
                     }
-                } else {
-                    if (dist[v] + 1 < dist[u]) {
-                        dist[u] = dist[v] + 1;
+                }
+                for (int u : graph_.neighbors(v)) {
+                    if (d[v] + 1 < d[u]) {
+                        d[u] = d[v] + 1;
                         que.push_back(u);
                     }
                 }
             }
         }
+        return dist;
+    }
 
-        vector<vector<vector<int>>> paths(n_); // paths[i] := { s-i shortest path の集合 }
-        paths[s].push_back({s});
+    // リングの頂点 s, t の間の最短路の集合
+    // after_contract = true ならば contract に含まれる辺を縮約した場合の最短路を考える。
+    // 初めて呼ばれたときに s からの最短路をまとめて計算して、Configuration が保持しているものの参照を返す。
+    const PathList &shortestPaths(int s, int t, bool after_contract=false) const {
+        assert(s < r_ && t < r_);
+        profileCount(profile_, CounterShortestPaths);
+        const auto &cache = after_contract ? contracted_shortest_paths_ : shortest_paths_;
+        return cache.get(s, [&] {
+            return calcShortestPaths(s, after_contract);
+        })[t];
+    }
+
+    // s からリングの各頂点への shortestPaths の列挙
+    // after_contract = true ならば contract に含まれる辺を縮約した場合の最短路を考える。
+    // 最短路は (1 つ手前までのパス, 最後の頂点) のノードとして共有して持ち、
+    // 各頂点 v について s-v 最短路のノードを見つけた順に paths[v] に並べる。
+    std::vector<PathList> calcShortestPaths(int s, bool after_contract=false) const {
+        ScopedTimer timer(profile_, PhaseShortestPaths);
+        profileCount(profile_, CounterShortestPathsComputed);
+        const uint8_t *dist = after_contract ? dist_contracted_[s] : dist_[s];
+        std::deque<int> que;
+
+        // ノード i は、ノード parent[i] のパスの後ろに vertex[i] を加えたパス
+        // on_path[i] := ノード i のパスに含まれる頂点の集合
+        std::vector<int> parent = {-1};
+        std::vector<uint8_t> vertex = {(uint8_t)s};
+        std::vector<VertexSet> on_path(1);
+        on_path[0].set(s);
+        std::vector<std::vector<int>> paths(n_); // paths[i] := { s-i shortest path のノードの集合 }
+        // extended[i] := paths[i] のうち既に隣接頂点へ延ばしたノードの数
+        std::vector<size_t> extended(n_, 0);
+        paths[s].push_back(0);
         que.push_back(s);
         while (!que.empty()) {
             int v = que.front();
             que.pop_front();
-            for (int u : VtoV_[v]) {
-                if (dist[u] == dist[v] + 1 || (dist[u] == dist[v] && contract_set.count({u, v}))) {
+            // paths[v] のうち前回 v を取り出した後に加わったものだけを延ばす。
+            // (それ以前のものは既に延ばしてある)
+            size_t begin = extended[v], end = paths[v].size();
+            extended[v] = end;
+            for (int u : graph_.neighbors(v)) {
+                if (dist[u] == dist[v] + 1 || (dist[u] == dist[v] && after_contract && contracted_.adjacent(u, v))) {
                     bool update = false;
-                    for (auto &path : paths[v]) { // path は変更してはいけない
-                        path.push_back(u);
-                        // + path が既に paths[u] に入っている
-                        // + path は既に u を含んでいる (次に u を通ると path ではなくなる)
-                        // 場合は update する必要がない。
-                        if ((std::find(paths[u].begin(), paths[u].end(), path) != paths[u].end()) ||
-                            (std::find(path.begin(), path.end(), u) != --path.end())) {
-                            path.pop_back();
+                    for (size_t i = begin;i < end; i++) {
+                        int node = paths[v][i];
+                        // path が既に u を含んでいる (次に u を通ると path ではなくなる) 場合は延ばさない。
+                        if (on_path[node].test(u)) {
                             continue;
                         }
-                        path.pop_back();
-
-                        vector<int> upath = path;
-                        upath.push_back(u);
-                        paths[u].push_back(upath);
+                        parent.push_back(node);
+                        vertex.push_back((uint8_t)u);
+                        on_path.push_back(on_path[node]);
+                        on_path.back().set(u);
+                        paths[u].push_back((int)parent.size() - 1);
                         update = true;
                     }
                     if (update) {
@@ -268,31 +536,30 @@ struct Configuration {
             }
         }
 
-
-        vector<vector<int>> unique_paths;
-        for (const vector<int> &path : paths[t]) {
-            bool unique = true;
-            for (const vector<int> &unique_path : unique_paths) {
-                if (path == unique_path) {
-                    unique = false;
-                    break;
+        std::vector<PathList> ring_paths(r_);
+        std::vector<uint8_t> reversed;
+        for (int t = 0;t < r_; t++) {
+            for (int node : paths[t]) {
+                reversed.clear();
+                for (int i = node;i != -1;i = parent[i]) {
+                    reversed.push_back(vertex[i]);
                 }
-            }
-            if (unique) {
-                unique_paths.push_back(path);
+                for (auto it = reversed.rbegin();it != reversed.rend(); ++it) {
+                    ring_paths[t].pushVertex(*it);
+                }
+                ring_paths[t].closePath();
             }
         }
-
-        return unique_paths;
+        return ring_paths;
     }
 
-    // p, q 間の長さ 7 以下のパスを列挙する。
-    vector<vector<int>> calculatePaths(int p, int q) const {
-        vector<vector<int>> paths;
-        auto dfs = [&](auto &&dfs, int v, vector<int> &path) -> void {
-            path.push_back(v);
+    // p, q 間の長さ 7 以下のパスを列挙して f に渡す。
+    template <typename F>
+    void calculatePaths(int p, int q, F &&f) const {
+        auto dfs = [&](auto &&dfs, int v, std::vector<uint8_t> &path) -> void {
+            path.push_back((uint8_t)v);
             if (path.back() == q) {
-                paths.push_back(path);
+                f(Path(path));
                 path.pop_back();
                 return;
             }
@@ -300,7 +567,7 @@ struct Configuration {
                 path.pop_back();
                 return;
             }
-            for (int u : VtoV_[v]) {
+            for (int u : graph_.neighbors(v)) {
                 if (std::find(path.begin(), path.end(), u) == path.end()) {
                     dfs(dfs, u, path);
                 }
@@ -308,49 +575,83 @@ struct Configuration {
             path.pop_back();
             return;
         };
-        vector<int> path;
+        std::vector<uint8_t> path;
         dfs(dfs, p, path);
-        return paths;
+        return;
     }
 
-    // contract_ の辺を縮約した後に
-    // cut に含まれる頂点集合によって分けられるどの連結成分に属しているかを表す id を返す。
-    vector<int> componentIdEquivalence(const vector<int> &cut) const {
-        // cut 頂点集合の計算
-        set<int> cutset;
-        for (int v : cut) {
-            cutset.insert(v);
-            for (int u = 0;u < n_; u++) {
-                if (equivalent(v, u)) {
-                    cutset.insert(u);
+    // リングの頂点の組 p, q ごとに長さ 7 以下のパスを列挙して、PathSummary と一緒に PathStore に格納する。
+    PathStore calcAllPaths(void) const {
+        ScopedTimer timer(profile_, PhaseAllPaths);
+        PathStore store;
+        size_t num_paths = 0;
+        for (int p = 0;p < r_; p++) {
+            for (int q = 0;q < r_; q++) {
+                if (p != q) {
+                    calculatePaths(p, q, [&](Path path) {
+                        PathSummary summary;
+                        summary.length = (uint8_t)(path.size() - 1);
+                        summary.number_in_ring = 0;
+                        for (size_t i = 0;i < path.size() - 1; i++) {
+                            if (path[i] < r_ && path[i + 1] < r_) summary.number_in_ring++;
+                        }
+                        auto [s, t] = sizeOfVertices(path);
+                        summary.ring_size = (uint8_t)s;
+                        summary.inside_size = (uint8_t)t;
+                        store.push_back(path, summary);
+                        num_paths++;
+                    });
                 }
+                store.closeGroup();
             }
         }
+        profileCount(profile_, CounterEnumeratedPaths, num_paths);
+        return store;
+    }
 
-        vector<int> component_id(n_, -1);
-        auto dfs = [&](auto &&dfs, int v, int c) -> void {
-            component_id[v] = c;
-            for (int u : VtoV_[v]) {
-                if (cutset.count(u)) {
-                    continue;
-                }
-                if (component_id[u] != -1) {
-                    continue;
-                }
-                dfs(dfs, u, c);
-            }
-            return;
-        };
-        // リングに接続している頂点は外側のグラフで繋がっている
-        for (int v = 0;v < r_; v++) {
-            if (!cutset.count(v)) {
-                dfs(dfs, v, 0);
-            }
+    // allowed に含まれる頂点だけを通って seed から到達できる頂点の集合を返す。
+    // (frontier をビット並列に広げる BFS)
+    VertexSet reach(const VertexSet &seed, const VertexSet &allowed) const {
+        VertexSet visited = seed & allowed;
+        VertexSet frontier = visited;
+        while (frontier.any()) {
+            VertexSet next;
+            frontier.forEach([&](int v) {
+                next |= neighbor_mask_[v];
+            });
+            next &= allowed;
+            next -= visited;
+            visited |= next;
+            frontier = next;
+        }
+        return visited;
+    }
+
+    // cut に含まれる頂点と、contract_ の辺を縮約した後にそれらと同じ頂点になる頂点の集合
+    VertexSet cutMask(const std::vector<int> &cut) const {
+        VertexSet cutset;
+        for (int v : cut) {
+            cutset.set(v);
+            cutset |= class_mask_[v];
         }
+        return cutset;
+    }
+
+    // contract_ の辺を縮約した後に
+    // cut に含まれる頂点集合によって分けられるどの連結成分に属しているかを表す id を返す。
+    std::vector<int> componentIdEquivalence(const std::vector<int> &cut) const {
+        VertexSet remaining = VertexSet::range(n_) - cutMask(cut);
+        std::vector<int> component_id(n_, -1);
+        // リングに接続している頂点は外側のグラフで繋がっている
+        reach(ring_mask_, remaining).forEach([&](int v) {
+            component_id[v] = 0;
+        });
         int num_component = 1;
         for (int v = r_;v < n_; v++) {
-            if (!cutset.count(v) && component_id[v] == -1) {
-                dfs(dfs, v, num_component);
+            if (remaining.test(v) && component_id[v] == -1) {
+                reach(VertexSet::range(v + 1) - VertexSet::range(v), remaining).forEach([&](int u) {
+                    component_id[u] = num_component;
+                });
                 num_component++;
             }
         }
@@ -358,16 +659,49 @@ struct Configuration {
         return component_id;
     }
 
-    void updateIsReductable(vector<bool> &is_reductable, const vector<int> &component_id, const vector<bool> &is_ring) const {
-        vector<bool> is_reducing_component(n_, true);
-        for (int v = 0;v < n_; v++) {
-            if (component_id[v] != -1 && is_ring[v]) {
-                is_reducing_component[component_id[v]] = false;
+    // calcCutReduction で cut を 1 頂点ずつ大きくしていくときの、cut を除いたグラフの連結成分の状態
+    struct CutComponents {
+        // ring の頂点を含む連結成分 (外側のグラフで繋がっているので消えない)
+        VertexSet ring_side;
+        // ring の頂点を含まないが、ring の頂点と同一視される頂点 (is_ring) を含む連結成分
+        // (これ以上 cut を大きくすると分割されて消える部分ができる可能性がある)
+        std::vector<VertexSet> open;
+    };
+
+    // rest をさらに連結成分に分けて、is_ring を含まないものの頂点を is_reductable に、含むものを next.open に加える。
+    void splitComponents(VertexSet rest, const VertexSet &is_ring, VertexSet &is_reductable, CutComponents &next) const {
+        while (rest.any()) {
+            VertexSet seed;
+            seed.set(rest.first());
+            VertexSet component = reach(seed, rest);
+            rest -= component;
+            if ((component & is_ring).none()) {
+                is_reductable |= component;
+            } else {
+                next.open.push_back(component);
             }
         }
-        for (int v = 0;v < n_; v++) {
-            if (component_id[v] != -1 && is_reducing_component[component_id[v]]) {
-                is_reductable[v] = true;
+        return;
+    }
+
+    // prev の状態から cut に cls を加えたときの状態を next に計算する。
+    // cls と交わる連結成分だけを分割し直す。
+    // (is_ring を含まない連結成分を分割してできる連結成分は既に is_reductable に含まれているので、prev.open には入れていない)
+    void extendCut(const CutComponents &prev, const VertexSet &cls, const VertexSet &is_ring,
+                   VertexSet &is_reductable, CutComponents &next) const {
+        next.open.clear();
+        if ((prev.ring_side & cls).any()) {
+            VertexSet rest = prev.ring_side - cls;
+            next.ring_side = reach(ring_mask_, rest);
+            splitComponents(rest - next.ring_side, is_ring, is_reductable, next);
+        } else {
+            next.ring_side = prev.ring_side;
+        }
+        for (const VertexSet &component : prev.open) {
+            if ((component & cls).any()) {
+                splitComponents(component - cls, is_ring, is_reductable, next);
+            } else {
+                next.open.push_back(component);
             }
         }
         return;
@@ -375,104 +709,119 @@ struct Configuration {
 
     // contract_ を縮約した後にできる conf の中の 2,3-cut 
     // によって消える可能性のある頂点かどうかを表すフラグを計算する。
-    vector<bool> calcCutReduction(void) const {
-        vector<bool> is_reductable(n_, false);
-        vector<bool> is_ring(n_, false); // ring の頂点か、ring の頂点と同一視される頂点か
+    // cut {v0, v1, v2} の連結成分は cut {v0, v1} の連結成分のうち v2 と同一視される頂点を含むものだけを分割して求める。
+    std::vector<bool> calcCutReduction(void) const {
+        ScopedTimer timer(profile_, PhaseCutReduction);
+        VertexSet is_reductable;
+        VertexSet is_ring; // ring の頂点か、ring の頂点と同一視される頂点か
         for (int v = 0;v < r_; v++) {
-            for (int u = 0;u < n_; u++) {
-                if (equivalent(v, u)) {
-                    is_ring[u] = true;
-                }
-            }
+            is_ring |= class_mask_[v];
         }
+        // cuts[k] := k 頂点の cut を除いたときの状態
+        std::vector<CutComponents> cuts(4);
+        VertexSet all = VertexSet::range(n_);
+        cuts[0].ring_side = reach(ring_mask_, all);
+        splitComponents(all - cuts[0].ring_side, is_ring, is_reductable, cuts[0]);
         for (int v0 = 0;v0 < n_; v0++) {
-            vector<int> component_id = componentIdEquivalence({v0});
-            updateIsReductable(is_reductable, component_id, is_ring);
+            extendCut(cuts[0], class_mask_[v0], is_ring, is_reductable, cuts[1]);
             for (int v1 = 0;v1 < v0; v1++) {
-                vector<int> component_id = componentIdEquivalence({v0, v1});
-                updateIsReductable(is_reductable, component_id, is_ring);
+                extendCut(cuts[1], class_mask_[v1], is_ring, is_reductable, cuts[2]);
                 for (int v2 = 0;v2 < v1; v2++) {
-                    vector<int> component_id = componentIdEquivalence({v0, v1, v2});
-                    updateIsReductable(is_reductable, component_id, is_ring);
+                    extendCut(cuts[2], class_mask_[v2], is_ring, is_reductable, cuts[3]);
                 }
             }
         }
-        return is_reductable;
+        std::vector<bool> result(n_, false);
+        is_reductable.forEach([&](int v) {
+            result[v] = true;
+        });
+        return result;
     }
 
-    // リング上の頂点 p, q が端点であるようなパス pqpath があるとき、
-    // pqpath によって分けられる頂点集合のうち、
-    // + p < q ならば p+1, p+2, ... , q-1 が
-    // + p > q ならば (p+1)%r, (p+2)%r, ... , (q+r-1)%r が 
-    // 含まれる方の頂点集合を返す。
-    vector<int> getComponent(const vector<int> &pqpath) const {
-        int p = pqpath[0], q = pqpath.back();
-        assert(p != q && p < r_ && q < r_);
+    // path の頂点の集合
+    static VertexSet pathMask(Path path) {
+        VertexSet mask;
+        for (int v : path) {
+            mask.set(v);
+        }
+        return mask;
+    }
 
-        set<int> cutset;
-        for (int v : pqpath) {
-            cutset.insert(v);
+    // path に含まれる頂点と、contract_ の辺を縮約した後にそれらと同じ頂点になる頂点の集合
+    VertexSet cutMask(Path path) const {
+        VertexSet cutset;
+        for (int v : path) {
+            cutset |= class_mask_[v];
         }
+        return cutset;
+    }
 
-        vector<int> component_id(n_, -1);
-        vector<int> component;
-        auto dfs = [&](auto &&dfs, int v, int c) -> void {
-            if (cutset.count(v) || component_id[v] != -1) {
-                return;
-            }
-            component_id[v] = c;
-            component.push_back(v);
-            for (int u : VtoV_[v]) {
-                dfs(dfs, u, c);
-            }
-            return;
-        };
-        for (int v = (p + 1) % r_;v != q;v = (v + 1) % r_) {
-            dfs(dfs, v, 0);
+    // リングの頂点 (p+1)%r, (p+2)%r, ..., (q+r-1)%r の集合
+    VertexSet ringInterval(int p, int q) const {
+        if (p < q) {
+            return VertexSet::range(q) - VertexSet::range(p + 1);
         }
+        return (ring_mask_ - VertexSet::range(p + 1)) | VertexSet::range(q);
+    }
+
+    // リング上の頂点 p, q を含む頂点集合 cut があるとき、
+    // cut によって分けられる頂点集合のうち ringInterval(p, q) が含まれる方の頂点集合を返す。
+    VertexSet componentMask(const VertexSet &cut, int p, int q) const {
+        assert(p != q && p < r_ && q < r_);
+        profileCount(profile_, CounterComponents);
+        return reach(ringInterval(p, q), VertexSet::range(n_) - cut);
+    }
+
+    // getComponent(pqpath) の頂点集合
+    VertexSet componentMask(Path pqpath) const {
+        return componentMask(pathMask(pqpath), pqpath[0], pqpath.back());
+    }
+
+    // getComponent(q1p2_path, q2p1_path) の頂点集合
+    VertexSet componentMask(Path q1p2_path, Path q2p1_path) const {
+        // q2p1_path を逆向きにした p1q2_path で分けられる頂点集合から q1p2_path で分けられる頂点集合を除く。
+        return componentMask(pathMask(q2p1_path), q2p1_path.back(), q2p1_path[0]) - componentMask(q1p2_path);
+    }
+
+    // getComponent2(q1p2_path, q2p1_path) の頂点集合
+    VertexSet componentMask2(Path q1p2_path, Path q2p1_path) const {
+        return componentMask(q1p2_path) ^ componentMask(q2p1_path);
+    }
+
+    // component に含まれるリングの頂点の数と、リングの内側の頂点の数
+    std::pair<int, int> sizeOfComponent(const VertexSet &component) const {
+        return std::make_pair((component & ring_mask_).count(), (component - ring_mask_).count());
+    }
+
+    static std::vector<int> toVector(const VertexSet &mask) {
+        std::vector<int> vertices;
+        mask.forEach([&](int v) {
+            vertices.push_back(v);
+        });
+        return vertices;
+    }
 
-        return component;
+    // リング上の頂点 p, q が端点であるようなパス pqpath があるとき、
+    // pqpath によって分けられる頂点集合のうち、
+    // + p < q ならば p+1, p+2, ... , q-1 が
+    // + p > q ならば (p+1)%r, (p+2)%r, ... , (q+r-1)%r が 
+    // 含まれる方の頂点集合を返す。
+    std::vector<int> getComponent(Path pqpath) const {
+        return toVector(componentMask(pqpath));
     }
 
     // リング上で p1, q1, p2, q2 の順に並んでいる頂点について、
     // q1 と p2 を結ぶパスを q1p2_path, q2 と p1 を結ぶパスを q2p1_path としたとき、
     // その 2 つのパスに囲まれる configuration の連結成分の頂点集合を得る。(2つのパスが交わっているときは厳密には異なる。)
-    vector<int> getComponent(const vector<int> &q1p2_path, const vector<int> &q2p1_path) const {
-        set<int> component2;
-        for (int v : getComponent(q1p2_path)) {
-            component2.insert(v);
-        }
-        vector<int> p1q2_path = q2p1_path;
-        std::reverse(p1q2_path.begin(), p1q2_path.end());
-        vector<int> component;
-        for (int v : getComponent(p1q2_path)) {
-            if (!component2.count(v)) {
-                component.push_back(v);
-            }
-        }
-        return component;
+    std::vector<int> getComponent(Path q1p2_path, Path q2p1_path) const {
+        return toVector(componentMask(q1p2_path, q2p1_path));
     }
 
     // リング上で p1, q1, p2, q2 の順に並んでいる頂点について、
     // q1 と p2 を結ぶパスを q1p2_path, q2 と p1 を結ぶパスを q2p1_path としたとき、
     // その 2 つのパスに囲まれる configuration の連結成分と 2 つのパスの頂点 "以外" の頂点集合を得る。(2つのパスが交わっているときは厳密には異なる。)
-    vector<int> getComponent2(const vector<int> &q1p2_path, const vector<int> &q2p1_path) const {
-        set<int> component2;
-        for (int v : getComponent(q1p2_path)) {
-            component2.insert(v);
-        }
-        vector<int> component;
-        for (int v : getComponent(q2p1_path)) {
-            if (component2.count(v) > 0) {
-                component2.erase(v);
-                continue;
-            }
-            component.push_back(v);
-        }
-        for (int v : component2) {
-            component.push_back(v);
-        }
-        return component;
+    std::vector<int> getComponent2(Path q1p2_path, Path q2p1_path) const {
+        return toVector(componentMask2(q1p2_path, q2p1_path));
     }
 
     // リング上の頂点 p, q が端点であるようなパス pqpath があるとき、
@@ -480,58 +829,61 @@ struct Configuration {
     // + p < q ならば p+1, p+2, ... , q-1 が
     // + p > q ならば (p+1)%r, (p+2)%r, ... , (q+r-1)%r が 
     // 含まれる方の頂点集合サイズを計算する。
-    pair<int, int> sizeOfVertices(const vector<int> &pqpath) const {
-        vector<int> component = getComponent(pqpath);
-
-        int s = 0; // ring
-        int t = 0; // inside ring
-        for (int v : component) {
-            if (v < r_) {
-                s++;
-            } else if (v >= r_) {
-                t++;
-            }
-        }
-
-        return std::make_pair(s, t);
+    std::pair<int, int> sizeOfVertices(Path pqpath) const {
+        return sizeOfComponent(componentMask(pqpath));
     }
 
     // リング上で p1, q1, p2, q2 の順に並んでいる頂点について、
     // q1 と p2 を結ぶパスを q1p2_path, q2 と p1 を結ぶパスを q2p1_path としたとき、
     // その 2 つのパスに囲まれる configuration の連結成分の頂点集合サイズを計算する。
-    pair<int, int> sizeOfVertices(const vector<int> &q1p2_path, const vector<int> &q2p1_path) const {
-        vector<int> component = getComponent(q1p2_path, q2p1_path);
-
-        int s = 0; // ring
-        int t = 0; // inside ring
-        for (int v : component) {
-            if (v < r_) {
-                s++;
-            } else if (v >= r_) {
-                t++;
-            }
-        }
-
-        return std::make_pair(s, t);
+    std::pair<int, int> sizeOfVertices(Path q1p2_path, Path q2p1_path) const {
+        return sizeOfComponent(componentMask(q1p2_path, q2p1_path));
     }
 
     // リング上で p1, q1, p2, q2 の順に並んでいる頂点について、
     // q1 と p2 を結ぶパスを q1p2_path, q2 と p1 を結ぶパスを q2p1_path としたとき、
     // その 2 つのパスに囲まれる configuration の連結成分と 2 つのパスの頂点 "以外" の頂点集合のサイズを計算する。
-    pair<int, int> sizeOfVertices2(const vector<int> &q1p2_path, const vector<int> &q2p1_path) const {
-        vector<int> component = getComponent2(q1p2_path, q2p1_path);
+    std::pair<int, int> sizeOfVertices2(Path q1p2_path, Path q2p1_path) const {
+        return sizeOfComponent(componentMask2(q1p2_path, q2p1_path));
+    }
 
-        int s = 0; // ring
-        int t = 0; // inside ring
-        for (int v : component) {
-            if (v < r_) {
-                s++;
-            } else if (v >= r_) {
-                t++;
-            }
-        }
+    // リングの頂点の組ごとの長さ 7 以下の全てのパス
+    const PathStore &allPaths(void) const {
+        return all_paths_.get(0, [&] { return calcAllPaths(); });
+    }
 
-        return std::make_pair(s, t);
+    // 長さ CutSize のサイクルに囲われているときの length_tables_[Length6] / length_tables_[Length7]
+    template <int CutSize>
+    const ByteMatrix &lowerBoundLength(void) const {
+        static_assert(CutSize == 6 || CutSize == 7);
+        return length_tables_.get(CutSize == 6 ? Length6 : Length7, [&] {
+            ScopedTimer timer(profile_, PhaseLengthTables);
+            return calcLowerBoundLengthOuterPath<CutSize>();
+        });
+    }
+
+    // 長さ CutSize のサイクルに囲われているときの length_tables_[LengthOneEdge6] / length_tables_[LengthOneEdge7]
+    template <int CutSize>
+    const ByteMatrix &lowerBoundLengthOneEdge(void) const {
+        static_assert(CutSize == 6 || CutSize == 7);
+        return length_tables_.get(CutSize == 6 ? LengthOneEdge6 : LengthOneEdge7, [&] {
+            ScopedTimer timer(profile_, PhaseLengthTables);
+            return calcLowerBoundLengthOuterPathOneEdge<CutSize>();
+        });
+    }
+
+    // contract_ を縮約した結果 conf の中にできる 2,3-cut reduction によって削除される頂点集合
+    const std::vector<bool> &isReductableInside(void) const {
+        return reductable_.get(ReductableInside, [&] { return calcCutReduction(); });
+    }
+
+    // 長さ CutSize のサイクルに囲われているときに conf の外にできる 2,3-cut reduction によって削除される頂点集合
+    template <int CutSize>
+    const std::vector<bool> &isReductableOutside(void) const {
+        static_assert(CutSize == 6 || CutSize == 7);
+        return reductable_.get(CutSize == 6 ? ReductableOutside6 : ReductableOutside7, [&] {
+            return calcReductableVertices<CutSize>();
+        });
     }
 
     // (conf + ring) の中にある path P と (conf + ring) の外で P の端点を結ぶ長さが k のパス
@@ -539,17 +891,15 @@ struct Configuration {
     // + path の辺が全て ring の辺である。
     // + path が 2 or 3 辺を除いて ring の辺であるようなパスであり、 C' の長さが 7 であり、6 サイクルの中にある。
     // この条件で C' が C (やそれに近いサイクル)になりうるかを調べている。
-    bool canBeAlmostMinimal(const vector<int> &path, int k, int cutSize) const {
-        assert(path[0] < r_ && path.back() < r_);
-        int number_in_ring = 0;
-        for (size_t i = 0;i < path.size() - 1; i++) {
-            if (path[i] < r_ && path[i + 1] < r_) number_in_ring ++;
-        }
-        int pathlen = (int)path.size() - 1;
+    // (path の PathSummary から判定する)
+    template <int CutSize>
+    bool canBeAlmostMinimal(const PathSummary &path, int k) const {
+        int number_in_ring = path.number_in_ring;
+        int pathlen = path.length;
         assert(pathlen >= 1);
         if ((number_in_ring == pathlen && pathlen + k >= 6) ||
             ((pathlen <= 3 || number_in_ring >= pathlen - 3) &&
-              pathlen + k == 7 && cutSize == 6)) {
+              pathlen + k == 7 && CutSize == 6)) {
             return true;
         }
         return false;
@@ -560,7 +910,8 @@ struct Configuration {
     // + path1, path2 の辺が全て ring の辺である。
     // + path1, path2 が 2 or 3 辺を除いて ring の辺であるようなパスで C' の長さが 7 であり、6 サイクルの中にある。
     // この条件で C' が C (やそれに近いサイクル)になりうるかを調べている。
-    bool canBeAlmostMinimal(const vector<int> &path1, const vector<int> &path2, int k1, int k2, int cutSize) const {
+    template <int CutSize>
+    bool canBeAlmostMinimal(Path path1, Path path2, int k1, int k2) const {
         assert(path1[0] < r_ && path1.back() < r_);
         int number_in_ring1 = 0;
         for (size_t i = 0;i < path1.size() - 1; i++) {
@@ -579,13 +930,14 @@ struct Configuration {
         int k = k1 + k2;
         if ((number_in_ring == pathlen && pathlen + k >= 6) ||
             ((pathlen <= 3 || number_in_ring >= pathlen - 3) &&
-              pathlen + k == 7 && cutSize == 6)) {
+              pathlen + k == 7 && CutSize == 6)) {
             return true;
         }
         return false;
     }
 
-    bool canBeAlmostMinimal2(const vector<int> &path1, const vector<int> &path2, int k1, int k2, int cutSize) const {
+    template <int CutSize>
+    bool canBeAlmostMinimal2(Path path1, Path path2, int k1, int k2) const {
         assert(path1[0] < r_ && path1.back() < r_);
         int number_in_ring1 = 0;
         for (size_t i = 0;i < path1.size() - 1; i++) {
@@ -601,27 +953,46 @@ struct Configuration {
 
         int num_inside = k1 + (pathlen1 - number_in_ring1) + (pathlen2 - number_in_ring2);
         int l = pathlen1 + pathlen2 + k1 + k2;
-        return ((num_inside == 0 && l >= 6) || (num_inside <= 3 && l == 7 && cutSize == 6));
+        return ((num_inside == 0 && l >= 6) || (num_inside <= 3 && l == 7 && CutSize == 6));
     }
 
-    // conf が cutSize (=6,7) のサイクルに囲われているとき、
+    // conf が CutSize (=6,7) のサイクルに囲われているとき、
     // リングの頂点 a, b について、長さ k の ab-contractibly connected path が存在するとき、
     // そのパスが low-cut の条件に矛盾するかを調べる。
-    bool checkShortCycle(int a, int b, int k, int cutSize) const {
+    template <int CutSize>
+    bool checkShortCycle(int a, int b, int k) const {
+        if (profile_ == nullptr) {
+            return short_cycle_memo_.get(cycleMemoIndex<CutSize>(a, b, k), [&] {
+                return calcShortCycle<CutSize>(a, b, k);
+            });
+        }
+        bool miss = false;
+        bool result = short_cycle_memo_.get(cycleMemoIndex<CutSize>(a, b, k), [&] {
+            miss = true;
+            return calcShortCycle<CutSize>(a, b, k);
+        });
+        profile_->count(miss ? CounterShortCycleMisses : CounterShortCycleHits);
+        return result;
+    }
+
+    // checkShortCycle の計算
+    template <int CutSize>
+    bool calcShortCycle(int a, int b, int k) const {
         assert(a < r_ && b < r_ && a != b);
-        const vector<vector<int>> &abpaths = all_paths_[a][b];
-        for (auto R : abpaths) {
-            if (canBeAlmostMinimal(R, k, cutSize)) {
+        const PathStore &all_paths = allPaths();
+        for (size_t i : all_paths.indices(a * r_ + b)) {
+            const PathSummary &R = all_paths.summary(i);
+            if (canBeAlmostMinimal<CutSize>(R, k)) {
                 continue;
             }
-            int m = (int)R.size() - 1;
-            auto [s, t] = sizeOfVertices(R);
-            int sz = max(s - max(k-1, 0) + 1, 0) / 2 + t;
+            int m = R.length;
+            int s = R.ring_size, t = R.inside_size;
+            int sz = std::max(s - std::max(k-1, 0) + 1, 0) / 2 + t;
             if (isForbiddenCut(k+m, sz)) {
                 return true;
             }
             if (((k == 2 && m == 3) || (k == 1 && m == 4)) && s == 2 && t == 0 && 
-                VtoV_[(a + 1) % r_].size() <= 4 && VtoV_[(a + 2) % r_].size() <= 4) {
+                graph_.degree((a + 1) % r_) <= 4 && graph_.degree((a + 2) % r_) <= 4) {
                 return true;
             }
         }
@@ -629,78 +1000,96 @@ struct Configuration {
     }
 
     // 縮約後に contractible loop を持ちうるかのチェック
-    void canHaveContractibleLoop(void) const {
-        for (int cutSize = 6;cutSize <= 7; cutSize++) {
-            for (int p = 0;p < r_; p++) {
-                for (int q = 0;q < r_; q++) {
-                    if (p == q || p + 1 == q || (p == r_ - 1 && q == 0)) {
-                        continue;
-                    }
-                    int pathlen_min = 0;
-                    int pathlen_max = 1 - dist_contracted_[p][q];
-                    if (pathlen_min > pathlen_max) continue;
+    // 危険なケースの数を返す。findings が nullptr でなければ危険なケースを加える。
+    // policy が StopPolicy::FirstDanger なら最初の危険なケースで止める。
+    int canHaveContractibleLoop(std::vector<Finding> *findings = nullptr, StopPolicy policy = StopPolicy::All) const {
+        int num_dangerous = canHaveContractibleLoop<6>(findings, policy);
+        if (num_dangerous > 0 && policy == StopPolicy::FirstDanger) {
+            return num_dangerous;
+        }
+        return num_dangerous + canHaveContractibleLoop<7>(findings, policy);
+    }
 
-                    for (int pathlen = pathlen_min;pathlen <= pathlen_max; pathlen++) {
-                        if (checkShortCycle(p, q, pathlen, cutSize)) {
-                            continue;
-                        }
-                        spdlog::info("dangerous: may be a bridge by {},{}-contractible in {}-cycle, general", p, q, cutSize);
+    // 長さ CutSize のサイクルに囲われているときの canHaveContractibleLoop
+    template <int CutSize>
+    int canHaveContractibleLoop(std::vector<Finding> *findings = nullptr, StopPolicy policy = StopPolicy::All) const {
+        const bool stop = policy == StopPolicy::FirstDanger;
+        int num_dangerous = 0;
+        for (int p = 0;p < r_; p++) {
+            for (int q = 0;q < r_; q++) {
+                if (p == q || p + 1 == q || (p == r_ - 1 && q == 0)) {
+                    continue;
+                }
+                int pathlen_min = 0;
+                int pathlen_max = 1 - dist_contracted_[p][q];
+                if (pathlen_min > pathlen_max) continue;
+
+                for (int pathlen = pathlen_min;pathlen <= pathlen_max; pathlen++) {
+                    if (checkShortCycle<CutSize>(p, q, pathlen)) {
+                        continue;
                     }
+                    LOG_INFO("dangerous: may be a bridge by {},{}-contractible in {}-cycle, general", p, q, CutSize);
+                    if (findings) findings->push_back({"bridge (1 path)", {p, q}, CutSize});
+                    num_dangerous++;
+                    if (stop) return num_dangerous;
                 }
             }
-            const auto &length = cutSize == 6 ? length6_ : length7_;
-            for (int p1 = 0;p1 < r_; p1++) {
-                for (int q1_ = p1 + 1;q1_ < p1 + r_; q1_++) {
-                    for (int p2_ = q1_ + 1;p2_ < p1 + r_; p2_++) {
-                        for (int q2_ = p2_ + 1;q2_ < p1 + r_; q2_++) {
-                            int q1 = q1_ % r_;
-                            int p2 = p2_ % r_;
-                            int q2 = q2_ % r_;
-                            // p1, q1, p2, q2 の順にリングに並んでいる。
-                            int length_inside = dist_contracted_[q1][p2] + dist_contracted_[q2][p1];
-                            // p1q1-contractibly connected path & p2q2-contractibly connected path
-                            if (length_inside + length[p1][q1] + length[p2][q2] <= 1) {
-                                spdlog::info("dangerous: may be a bridge by {},{}-contractible, {},{}-contractible in {}-cycle, general", p1, q1, p2, q2, cutSize);
-                            }
-                            // p1q1-contractibly connected path & q2p2-contractibly connected path
-                            if (length_inside + length[p1][q1] + length[q2][p2] <= 1) {
-                                spdlog::info("dangerous: may be a bridge by {},{}-contractible, {},{}-contractible in {}-cycle, general", p1, q1, q2, p2, cutSize);
-                            }
+        }
+        const auto &length = lowerBoundLength<CutSize>();
+        for (int p1 = 0;p1 < r_; p1++) {
+            for (int q1_ = p1 + 1;q1_ < p1 + r_; q1_++) {
+                for (int p2_ = q1_ + 1;p2_ < p1 + r_; p2_++) {
+                    for (int q2_ = p2_ + 1;q2_ < p1 + r_; q2_++) {
+                        int q1 = q1_ % r_;
+                        int p2 = p2_ % r_;
+                        int q2 = q2_ % r_;
+                        // p1, q1, p2, q2 の順にリングに並んでいる。
+                        int length_inside = dist_contracted_[q1][p2] + dist_contracted_[q2][p1];
+                        // p1q1-contractibly connected path & p2q2-contractibly connected path
+                        if (length_inside + length[p1][q1] + length[p2][q2] <= 1) {
+                            LOG_INFO("dangerous: may be a bridge by {},{}-contractible, {},{}-contractible in {}-cycle, general", p1, q1, p2, q2, CutSize);
+                            if (findings) findings->push_back({"bridge (2 paths)", {p1, q1, p2, q2}, CutSize});
+                            num_dangerous++;
+                            if (stop) return num_dangerous;
+                        }
+                        // p1q1-contractibly connected path & q2p2-contractibly connected path
+                        if (length_inside + length[p1][q1] + length[q2][p2] <= 1) {
+                            LOG_INFO("dangerous: may be a bridge by {},{}-contractible, {},{}-contractible in {}-cycle, general", p1, q1, q2, p2, CutSize);
+                            if (findings) findings->push_back({"bridge (2 paths)", {p1, q1, q2, p2}, CutSize});
+                            num_dangerous++;
+                            if (stop) return num_dangerous;
                         }
                     }
                 }
             }
         }
-        return;
+        return num_dangerous;
     }
 
     // 1 本のパスで消える頂点を計算
-    void calcReductableVertices1(int cutSize, vector<bool> &is_reductable) const {
+    template <int CutSize>
+    void calcReductableVertices1(std::vector<bool> &is_reductable) const {
         for (int p = 0;p < r_; p++) {
             for (int q = 0;q < r_; q++) {
                 if (p == q) {
                     continue;
                 }
-                int pathlen_min = max(0, 5 - dist_[p][q]);
+                int pathlen_min = std::max(0, 5 - dist_[p][q]);
                 int pathlen_max = 3 - dist_contracted_[p][q];
                 if (pathlen_min > pathlen_max) continue;
-                vector<vector<int>> contracted_paths = shortestPaths(p, q, true);
+                const PathList &contracted_paths = shortestPaths(p, q, true);
 
                 for (int pathlen = pathlen_min;pathlen <= pathlen_max; pathlen++) {
-                    if (checkShortCycle(p, q, pathlen, cutSize)) {
+                    if (checkShortCycle<CutSize>(p, q, pathlen)) {
                         continue;
                     }
                     for (const auto &contracted_path : contracted_paths) {
                         if ((int)contracted_path.size() - 1 == dist_[p][q]) continue;
-                        auto reducing_component = getComponent(contracted_path);
-                        for (int v : reducing_component) {
-                            bool equivalent_path = false;
-                            for (int u : contracted_path) {
-                                if (equivalent(v, u)) equivalent_path = true;
-                            }
-                            if (equivalent_path) continue;
+                        // パスの頂点と同じ頂点になるものは除く。
+                        VertexSet reducing_component = componentMask(contracted_path) - cutMask(contracted_path);
+                        reducing_component.forEach([&](int v) {
                             is_reductable[v] = true;
-                        }
+                        });
                     }
                 }
             }
@@ -710,8 +1099,9 @@ struct Configuration {
 
     // p1, q1, p2, q2 がリングに順に並んでいるとき
     // contractible な 2 本のパス (p1q1-contractly connected path と p2q2-contractibly connected path) で消える頂点を計算
-    void calcReductableVertices2(int cutSize, vector<bool> &is_reductable) const {
-        for (int p1 = 0;p1 < r_; p1++) {
+    template <int CutSize>
+    void calcReductableVertices2(std::vector<bool> &is_reductable) const {
+        forEachRingVertex(is_reductable, [&](int p1, std::vector<bool> &partial) {
             for (int q1_ = p1 + 1;q1_ < p1 + r_; q1_++) {
                 for (int p2_ = q1_ + 1;p2_ < p1 + r_; p2_++) {
                     for (int q2_ = p2_ + 1;q2_ < p1 + r_; q2_++) {
@@ -719,35 +1109,35 @@ struct Configuration {
                         int p2 = p2_ % r_;
                         int q2 = q2_ % r_;
                         // p1, q1, p2, q2 の順にリングに並んでいる。
-                        int pathlen_min1 = max(0, 5 - dist_[p1][q1]);
-                        int pathlen_min2 = max(0, 5 - dist_[p2][q2]);
+                        int pathlen_min1 = std::max(0, 5 - dist_[p1][q1]);
+                        int pathlen_min2 = std::max(0, 5 - dist_[p2][q2]);
                         int pathlen_max = 3 - dist_contracted_[q1][p2] - dist_contracted_[q2][p1];
                         if (pathlen_min1 > pathlen_max || pathlen_min2 > pathlen_max) continue;
 
-                        vector<vector<int>> shortest_path1s = shortestPaths(q1, p2);
-                        vector<vector<int>> shortest_path2s = shortestPaths(q2, p1);
-                        vector<vector<int>> contracted_path1s = shortestPaths(q1, p2, true);
-                        vector<vector<int>> contracted_path2s = shortestPaths(q2, p1, true);
+                        const PathList &shortest_path1s = shortestPaths(q1, p2);
+                        const PathList &shortest_path2s = shortestPaths(q2, p1);
+                        const PathList &contracted_path1s = shortestPaths(q1, p2, true);
+                        const PathList &contracted_path2s = shortestPaths(q2, p1, true);
                         
                         for (int pathlen1 = pathlen_min1;pathlen1 <= pathlen_max; pathlen1++) {
                             for (int pathlen2 = pathlen_min2;pathlen2 <= pathlen_max; pathlen2++) {
                                 if (pathlen1 + pathlen2 + dist_contracted_[q1][p2] + dist_contracted_[q2][p1] > 3) {
                                     continue;
                                 }
-                                if (checkShortCycle(p1, q1, pathlen1, cutSize)) {
+                                if (checkShortCycle<CutSize>(p1, q1, pathlen1)) {
                                     continue;
                                 }
-                                if (checkShortCycle(p2, q2, pathlen2, cutSize)) {
+                                if (checkShortCycle<CutSize>(p2, q2, pathlen2)) {
                                     continue;
                                 }
                                 bool has_smallcut = false;
                                 for (const auto &shortest_path1 : shortest_path1s) {
                                     for (const auto &shortest_path2 : shortest_path2s) {
-                                        if (canBeAlmostMinimal(shortest_path1, shortest_path2, pathlen1, pathlen2, cutSize)) {
+                                        if (canBeAlmostMinimal<CutSize>(shortest_path1, shortest_path2, pathlen1, pathlen2)) {
                                             continue;
                                         }
                                         auto [s, t] = sizeOfVertices(shortest_path1, shortest_path2);
-                                        int sz = max(s - max(pathlen1 + pathlen2 - 2, 0) + 1, 0) / 2 + t;
+                                        int sz = std::max(s - std::max(pathlen1 + pathlen2 - 2, 0) + 1, 0) / 2 + t;
                                         if (isForbiddenCut(shortest_path1.size()+shortest_path2.size()-2+pathlen1+pathlen2, sz)) {
                                             has_smallcut = true;
                                             break;
@@ -761,18 +1151,12 @@ struct Configuration {
                                 for (const auto &contracted_path1 : contracted_path1s) {
                                     for (const auto &contracted_path2 : contracted_path2s) {
                                         if ((int)contracted_path1.size() - 1 == dist_[q1][p2] && (int)contracted_path2.size() - 1 == dist_[q2][p1]) continue;
-                                        auto reducing_component = getComponent(contracted_path1, contracted_path2);
-                                        for (int v : reducing_component) {
-                                            bool equivalent_path = false;
-                                            for (int u : contracted_path1) {
-                                                if (equivalent(v, u)) equivalent_path = true;
-                                            }
-                                            for (int u : contracted_path2) {
-                                                if (equivalent(v, u)) equivalent_path = true;
-                                            }
-                                            if (equivalent_path) continue;
-                                            is_reductable[v] = true;
-                                        }
+                                        // パスの頂点と同じ頂点になるものは除く。
+                                        VertexSet reducing_component = componentMask(contracted_path1, contracted_path2)
+                                                                       - cutMask(contracted_path1) - cutMask(contracted_path2);
+                                        reducing_component.forEach([&](int v) {
+                                            partial[v] = true;
+                                        });
                                     }
                                 }
                             }
@@ -781,58 +1165,59 @@ struct Configuration {
                     }
                 }
             }
-        }
+        });
         return;
     }
 
     // p1, q1 間に noncontractible に長さ pathlen1 のパスがあり、
     // p2, q2 間に noncontractible に長さ pathlen2 のパスがあるとき、
-    // cutSize (6 or 7) のサイクルがそれらのパスと両立するかのチェックをする。
-    int calcLowerBoundCycle(int p1, int q1, int p2, int q2, int pathlen1, int pathlen2, int cutSize) const {
+    // CutSize (6 or 7) のサイクルがそれらのパスと両立するかのチェックをする。
+    template <int CutSize>
+    int calcLowerBoundCycle(int p1, int q1, int p2, int q2, int pathlen1, int pathlen2) const {
         assert(pathlen1 + pathlen2 <= 3);
         // 6,7 サイクルと path1, path2 が両立するかどうかのチェック
-        const auto &length = cutSize == 6 ? length6_ : length7_;
-        const auto &length_oneedge = cutSize == 6 ? length_oneedge6_ : length_oneedge7_;
+        const auto &length = lowerBoundLength<CutSize>();
+        const auto &length_oneedge = lowerBoundLengthOneEdge<CutSize>();
 
-        int L_vertical = max(length[p1][q1], 2 - pathlen1) + max(length[p2][q2], 2 - pathlen2); // 元から rep = 1 なら Petersen-like にならないから 2 - pathlen_i
+        int L_vertical = std::max<int>(length[p1][q1], 2 - pathlen1) + std::max<int>(length[p2][q2], 2 - pathlen2); // 元から rep = 1 なら Petersen-like にならないから 2 - pathlen_i
         int L_horizontal = length[q1][p2] + length[q2][p1];
         int L = (L_vertical + pathlen1 + pathlen2 <= 5 && L_horizontal + pathlen1 + pathlen2 <= 5) ? // サイクルの外側の 2 つの領域がどちらも 5 カットなら 6,7 サイクルの頂点数の仮定に反する
-                (L_vertical + L_horizontal + 6 - pathlen1 - pathlen2 - max(L_vertical, L_horizontal)) : // から、そうでなくないように長さを伸ばす。
+                (L_vertical + L_horizontal + 6 - pathlen1 - pathlen2 - std::max(L_vertical, L_horizontal)) : // から、そうでなくないように長さを伸ばす。
                 L_vertical + L_horizontal;
         if (pathlen1 == 2) {
             // サイクルが pathlen1 の中点を 1 回通るとき
-            int L1_vertical = max(length_oneedge[p1][q1], 1) + max(length[p2][q2], 2 - pathlen2);
-            int L1_horizontal = min(length[q2][p1] + length_oneedge[q1][p2], length_oneedge[q2][p1] + length[q1][p2]);
+            int L1_vertical = std::max<int>(length_oneedge[p1][q1], 1) + std::max<int>(length[p2][q2], 2 - pathlen2);
+            int L1_horizontal = std::min(length[q2][p1] + length_oneedge[q1][p2], length_oneedge[q2][p1] + length[q1][p2]);
             int L1 = (L1_vertical + pathlen2 + 1 <= 5 && L1_horizontal + pathlen2 + 1 <= 5) ?
-                        (L1_vertical + L1_horizontal + 5 - pathlen2 - max(L1_vertical, L1_horizontal)) :
+                        (L1_vertical + L1_horizontal + 5 - pathlen2 - std::max(L1_vertical, L1_horizontal)) :
                         L1_vertical + L1_horizontal;
-            L = min(L, L1);
+            L = std::min(L, L1);
             if (pathlen2 == 1) {
                 // サイクルが p2 (または q2) を 2 回通るとき、
-                int L2_vertical = max(length[p1][q1], 2 - pathlen1) + max(length_oneedge[p2][q2], 2);
-                int L2_horizontal = min(length[q2][p1] + length_oneedge[q1][p2], length_oneedge[q2][p1] + length[q1][p2]);
+                int L2_vertical = std::max<int>(length[p1][q1], 2 - pathlen1) + std::max<int>(length_oneedge[p2][q2], 2);
+                int L2_horizontal = std::min(length[q2][p1] + length_oneedge[q1][p2], length_oneedge[q2][p1] + length[q1][p2]);
                 int L2 = (L2_vertical + pathlen1 <= 5 && L2_horizontal + pathlen1 <= 5) ?
-                         (L2_vertical + L2_horizontal + 6 - pathlen1 - max(L2_horizontal, L2_vertical)) :
+                         (L2_vertical + L2_horizontal + 6 - pathlen1 - std::max(L2_horizontal, L2_vertical)) :
                          L2_vertical + L2_horizontal;
-                L = min(L, L2);
+                L = std::min(L, L2);
             }
         }
         if (pathlen2 == 2) {
             // サイクルが pathlen2 の中点を 1 回通るとき
-            int L1_vertical = max(length[p1][q1], 2 - pathlen1) + max(length_oneedge[p2][q2], 1);
-            int L1_horizontal = min(length[q2][p1] + length_oneedge[q1][p2], length_oneedge[q2][p1] + length[q1][p2]);
+            int L1_vertical = std::max<int>(length[p1][q1], 2 - pathlen1) + std::max<int>(length_oneedge[p2][q2], 1);
+            int L1_horizontal = std::min(length[q2][p1] + length_oneedge[q1][p2], length_oneedge[q2][p1] + length[q1][p2]);
             int L1 = (L1_vertical + pathlen1 + 1 <= 5 && L1_horizontal + pathlen1 + 1 <= 5) ?
-                        (L1_vertical + L1_horizontal + 5 - pathlen1 - max(L1_vertical, L1_horizontal)) :
+                        (L1_vertical + L1_horizontal + 5 - pathlen1 - std::max(L1_vertical, L1_horizontal)) :
                         L1_vertical + L1_horizontal;
-            L = min(L, L1);
+            L = std::min(L, L1);
             if (pathlen1 == 1) {
                 // サイクルが p1 (または q1) を 2 回通るとき、
-                int L2_vertical = max(length_oneedge[p1][q1], 2) + max(length[p2][q2], 2 - pathlen2);
-                int L2_horizontal = min(length[q2][p1] + length_oneedge[q1][p2], length_oneedge[q2][p1] + length[q1][p2]);
+                int L2_vertical = std::max<int>(length_oneedge[p1][q1], 2) + std::max<int>(length[p2][q2], 2 - pathlen2);
+                int L2_horizontal = std::min(length[q2][p1] + length_oneedge[q1][p2], length_oneedge[q2][p1] + length[q1][p2]);
                 int L2 = (L2_vertical + pathlen2 <= 5 && L2_horizontal + pathlen2 <= 5) ?
-                         (L2_vertical + L2_horizontal + 6 - pathlen2 - max(L2_vertical, L2_horizontal)):
+                         (L2_vertical + L2_horizontal + 6 - pathlen2 - std::max(L2_vertical, L2_horizontal)):
                          L2_vertical + L2_horizontal;
-                L = min(L, L2);
+                L = std::min(L, L2);
             }
         }
         // どちらかの長さが 3 のときは trivial な下限しか考えない。
@@ -845,8 +1230,10 @@ struct Configuration {
 
     // p1, q1, p2, q2 がリングに順に並んでいるとき
     // noncontractible な 2 本のパス (p1q1-path と p2q2-path) で消える頂点を計算
-    void calcReductableVertices3(int cutSize, vector<bool> &is_reductable) const {
-        for (int p1 = 0;p1 < r_; p1++) {
+    template <int CutSize>
+    void calcReductableVertices3(std::vector<bool> &is_reductable) const {
+        const PathStore &all_paths = allPaths();
+        forEachRingVertex(is_reductable, [&](int p1, std::vector<bool> &partial) {
             for (int q1_ = p1 + 1;q1_ < p1 + r_; q1_++) {
                 for (int p2_ = q1_ + 1;p2_ < p1 + r_; p2_++) {
                     for (int q2_ = p2_ + 1;q2_ < p1 + r_; q2_++) {
@@ -858,18 +1245,18 @@ struct Configuration {
                         int q2 = q2_ % r_;
                         // p1, q1, p2, q2 の順にリングに並んでいる。
                         // 縮約後に rep <= 1 にならないための制約
-                        int pathlen_min1 = max(2 - dist_contracted_[p1][q1], 0);
-                        int pathlen_min2 = max(2 - dist_contracted_[p2][q2], 0);
+                        int pathlen_min1 = std::max(2 - dist_contracted_[p1][q1], 0);
+                        int pathlen_min2 = std::max(2 - dist_contracted_[p2][q2], 0);
                         int pathlen_max = 3 - dist_contracted_[q1][p2] - dist_contracted_[q2][p1];
                         if (pathlen_min1 > pathlen_max || pathlen_min2 > pathlen_max) continue;
     
                         assert(q1 != p2);
-                        const vector<vector<int>> &path1s = all_paths_[q1][p2];
+                        auto path1s = all_paths.indices(q1 * r_ + p2);
                         assert(q2 != p1);
-                        const vector<vector<int>> &path2s = all_paths_[q2][p1];
+                        auto path2s = all_paths.indices(q2 * r_ + p1);
 
-                        vector<vector<int>> contracted_path1s = shortestPaths(q1, p2, true);
-                        vector<vector<int>> contracted_path2s = shortestPaths(q2, p1, true);
+                        const PathList &contracted_path1s = shortestPaths(q1, p2, true);
+                        const PathList &contracted_path2s = shortestPaths(q2, p1, true);
                         
                         // p1-q1 間に pathlen1 の長さのパス、p2-q2 間に pathlen2 の長さのパス
                         for (int pathlen1 = pathlen_min1;pathlen1 <= pathlen_max; pathlen1++) {
@@ -879,18 +1266,18 @@ struct Configuration {
                                 }
 
                                 // 6,7 サイクルと path1, path2 が両立するかのチェック。
-                                int L = calcLowerBoundCycle(p1, q1, p2, q2, pathlen1, pathlen2, cutSize);
-                                if (L > cutSize) {
+                                int L = calcLowerBoundCycle<CutSize>(p1, q1, p2, q2, pathlen1, pathlen2);
+                                if (L > CutSize) {
                                     continue;
                                 }
 
                                 bool has_smallcut = false;
-                                for (const auto &path1 : path1s) {
-                                    for (const auto &path2 : path2s) {
-                                        int l = pathlen1 + pathlen2 + path1.size() - 1 + path2.size() - 1;
+                                for (size_t path1 : path1s) {
+                                    for (size_t path2 : path2s) {
+                                        int l = pathlen1 + pathlen2 + all_paths.summary(path1).length + all_paths.summary(path2).length;
                                         if (l > 5) continue;
-                                        auto [s, t] = sizeOfVertices2(path1, path2);
-                                        int sz = max(s - max(pathlen1 + pathlen2 - 2, 0) + 1, 0) / 2 + t;
+                                        auto [s, t] = sizeOfVertices2(all_paths.path(path1), all_paths.path(path2));
+                                        int sz = std::max(s - std::max(pathlen1 + pathlen2 - 2, 0) + 1, 0) / 2 + t;
                                         if ((l <= 4 && sz > 0) || (l == 5 && sz > 1)) {
                                             has_smallcut = true;
                                             break;
@@ -903,18 +1290,12 @@ struct Configuration {
                                 for (const auto &contracted_path1 : contracted_path1s) {
                                     for (const auto &contracted_path2 : contracted_path2s) {
                                         if ((int)contracted_path1.size() - 1 == dist_[q1][p2] && (int)contracted_path2.size() - 1 == dist_[q2][p1]) continue;
-                                        auto reducing_component = getComponent2(contracted_path1, contracted_path2);
-                                        for (int v : reducing_component) {
-                                            bool equivalent_path = false;
-                                            for (int u : contracted_path1) {
-                                                if (equivalent(v, u)) equivalent_path = true;
-                                            }
-                                            for (int u : contracted_path2) {
-                                                if (equivalent(v, u)) equivalent_path = true;
-                                            }
-                                            if (equivalent_path) continue;
-                                            is_reductable[v] = true;
-                                        }
+                                        // パスの頂点と同じ頂点になるものは除く。
+                                        VertexSet reducing_component = componentMask2(contracted_path1, contracted_path2)
+                                                                       - cutMask(contracted_path1) - cutMask(contracted_path2);
+                                        reducing_component.forEach([&](int v) {
+                                            partial[v] = true;
+                                        });
                                     }
                                 }
                             }
@@ -922,14 +1303,15 @@ struct Configuration {
                     }
                 }
             }
-        }
+        });
         return;
     }
 
     // p1, q1, p2, q2 がリングに順に並んでいるとき
     // contractible な 2 本のパス (p1q1-contractly connected path と q2p2-contractibly connected path) で消える頂点を計算
-    void calcReductableVertices4(int cutSize, vector<bool> &is_reductable) const {
-        for (int p1 = 0;p1 < r_; p1++) {
+    template <int CutSize>
+    void calcReductableVertices4(std::vector<bool> &is_reductable) const {
+        forEachRingVertex(is_reductable, [&](int p1, std::vector<bool> &partial) {
             for (int q1_ = p1 + 1;q1_ < p1 + r_; q1_++) {
                 for (int p2_ = q1_ + 1;p2_ < p1 + r_; p2_++) {
                     for (int q2_ = p2_ + 1;q2_ < p1 + r_; q2_++) {
@@ -937,35 +1319,35 @@ struct Configuration {
                         int p2 = p2_ % r_;
                         int q2 = q2_ % r_;
                         // p1, q1, p2, q2 の順にリングに並んでいる。
-                        int pathlen_min1 = max(0, 5 - dist_[p1][q1]);
-                        int pathlen_min2 = max(0, 5 - dist_[p2][q2]);
+                        int pathlen_min1 = std::max(0, 5 - dist_[p1][q1]);
+                        int pathlen_min2 = std::max(0, 5 - dist_[p2][q2]);
                         int pathlen_max = 3 - dist_contracted_[q1][p2] - dist_contracted_[q2][p1];
                         if (pathlen_min1 > pathlen_max || pathlen_min2 > pathlen_max) continue;
 
-                        vector<vector<int>> shortest_path1s = shortestPaths(q1, p2);
-                        vector<vector<int>> shortest_path2s = shortestPaths(q2, p1);
-                        vector<vector<int>> contracted_path1s = shortestPaths(q1, p2, true);
-                        vector<vector<int>> contracted_path2s = shortestPaths(q2, p1, true);
+                        const PathList &shortest_path1s = shortestPaths(q1, p2);
+                        const PathList &shortest_path2s = shortestPaths(q2, p1);
+                        const PathList &contracted_path1s = shortestPaths(q1, p2, true);
+                        const PathList &contracted_path2s = shortestPaths(q2, p1, true);
                         
                         for (int pathlen1 = pathlen_min1;pathlen1 <= pathlen_max; pathlen1++) {
                             for (int pathlen2 = pathlen_min2;pathlen2 <= pathlen_max; pathlen2++) {
                                 if (pathlen1 + pathlen2 + dist_contracted_[q1][p2] + dist_contracted_[q2][p1] > 3) {
                                     continue;
                                 }
-                                if (checkShortCycle(p1, q1, pathlen1, cutSize)) {
+                                if (checkShortCycle<CutSize>(p1, q1, pathlen1)) {
                                     continue;
                                 }
-                                if (checkShortCycle(q2, p2, pathlen2, cutSize)) {
+                                if (checkShortCycle<CutSize>(q2, p2, pathlen2)) {
                                     continue;
                                 }
                                 bool has_smallcut = false;
                                 for (const auto &shortest_path1 : shortest_path1s) {
                                     for (const auto &shortest_path2 : shortest_path2s) {
-                                        if (canBeAlmostMinimal2(shortest_path1, shortest_path2, pathlen1, pathlen2, cutSize)) {
+                                        if (canBeAlmostMinimal2<CutSize>(shortest_path1, shortest_path2, pathlen1, pathlen2)) {
                                             continue;
                                         }
                                         auto [s, t] = sizeOfVertices2(shortest_path1, shortest_path2);
-                                        int sz = max(s - max(pathlen1 + pathlen2 - 2, 0) + 1, 0) / 2 + t;
+                                        int sz = std::max(s - std::max(pathlen1 + pathlen2 - 2, 0) + 1, 0) / 2 + t;
                                         if (isForbiddenCut(shortest_path1.size()+shortest_path2.size()-2+pathlen1+pathlen2, sz)) {
                                             has_smallcut = true;
                                             break;
@@ -979,18 +1361,12 @@ struct Configuration {
                                 for (const auto &contracted_path1 : contracted_path1s) {
                                     for (const auto &contracted_path2 : contracted_path2s) {
                                         if ((int)contracted_path1.size() - 1 == dist_[q1][p2] && (int)contracted_path2.size() - 1 == dist_[q2][p1]) continue;
-                                        auto reducing_component = getComponent2(contracted_path1, contracted_path2);
-                                        for (int v : reducing_component) {
-                                            bool equivalent_path = false;
-                                            for (int u : contracted_path1) {
-                                                if (equivalent(v, u)) equivalent_path = true;
-                                            }
-                                            for (int u : contracted_path2) {
-                                                if (equivalent(v, u)) equivalent_path = true;
-                                            }
-                                            if (equivalent_path) continue;
-                                            is_reductable[v] = true;
-                                        }
+                                        // パスの頂点と同じ頂点になるものは除く。
+                                        VertexSet reducing_component = componentMask2(contracted_path1, contracted_path2)
+                                                                       - cutMask(contracted_path1) - cutMask(contracted_path2);
+                                        reducing_component.forEach([&](int v) {
+                                            partial[v] = true;
+                                        });
                                     }
                                 }
                             }
@@ -998,24 +1374,76 @@ struct Configuration {
                     }
                 }
             }
-        }
+        });
         return;
     }
    
+    // p1 = 0, ..., r_ - 1 について f(p1, partial) を呼び、partial に立てたフラグを is_reductable に加える。
+    // parallelism_ が並列化する設定なら p1 ごとに並列に実行する。(partial はタスクごとに別のもの)
+    template <typename F>
+    void forEachRingVertex(std::vector<bool> &is_reductable, F &&f) const {
+        int num_tasks = taskPool() == nullptr ? 1 : std::min(parallelism_.jobs, r_);
+        if (num_tasks == 1) {
+            for (int p1 = 0;p1 < r_; p1++) {
+                f(p1, is_reductable);
+            }
+            return;
+        }
+        std::vector<std::vector<bool>> partial(num_tasks, std::vector<bool>(n_, false));
+        parallelFor(taskPool(), num_tasks, 0, r_, [&](int p1, int task) {
+            f(p1, partial[task]);
+        });
+        for (const std::vector<bool> &flags : partial) {
+            for (int v = 0;v < n_; v++) {
+                if (flags[v]) is_reductable[v] = true;
+            }
+        }
+        return;
+    }
+
     // configuration の外を通る 2,3-cut reduction で消える可能性のある頂点かどうかを表すフラグを計算する。
-    vector<bool> calcReductableVertices(int cutSize) const {
-        assert(cutSize == 6 || cutSize == 7);
-        vector<bool> is_reductable(n_, false);
-        calcReductableVertices1(cutSize, is_reductable);
-        calcReductableVertices2(cutSize, is_reductable);
-        calcReductableVertices3(cutSize, is_reductable);
-        calcReductableVertices4(cutSize, is_reductable);
+    template <int CutSize>
+    std::vector<bool> calcReductableVertices(void) const {
+        std::vector<bool> is_reductable(n_, false);
+        {
+            ScopedTimer timer(profile_, PhaseReductableVertices1);
+            calcReductableVertices1<CutSize>(is_reductable);
+        }
+        {
+            ScopedTimer timer(profile_, PhaseReductableVertices2);
+            calcReductableVertices2<CutSize>(is_reductable);
+        }
+        {
+            ScopedTimer timer(profile_, PhaseReductableVertices3);
+            calcReductableVertices3<CutSize>(is_reductable);
+        }
+        {
+            ScopedTimer timer(profile_, PhaseReductableVertices4);
+            calcReductableVertices4<CutSize>(is_reductable);
+        }
         return is_reductable;
     }
 
-    bool forbiddenCycle(int a, int b, int k, int cutSize) const {
-        assert(cutSize == 6 || cutSize == 7);
-        assert(k <= cutSize);
+    // checkShortCycle, forbiddenCycle, forbiddenCycleOneEdge の結果を覚えておく位置
+    template <int CutSize>
+    size_t cycleMemoIndex(int a, int b, int k) const {
+        static_assert(CutSize == 6 || CutSize == 7);
+        assert(a < r_ && b < r_);
+        assert(0 <= k && k <= 7);
+        return ((size_t)(a * r_ + b) * 8 + k) * 2 + (CutSize - 6);
+    }
+
+    template <int CutSize>
+    bool forbiddenCycle(int a, int b, int k) const {
+        return forbidden_cycle_memo_.get(cycleMemoIndex<CutSize>(a, b, k), [&] {
+            return calcForbiddenCycle<CutSize>(a, b, k);
+        });
+    }
+
+    // forbiddenCycle の計算
+    template <int CutSize>
+    bool calcForbiddenCycle(int a, int b, int k) const {
+        assert(k <= CutSize);
         int b_ = a < b ? b : b + r_;
         int q = b_ - a;
 
@@ -1026,49 +1454,54 @@ struct Configuration {
             return true;
         } else {
             // E := P + R 
-            return checkShortCycle(a, b, k, cutSize);
+            return checkShortCycle<CutSize>(a, b, k);
         }
     }
 
-    bool forbiddenCycleOneEdge(int a, int b, int k, int cutSize) const {
-        assert(cutSize == 6 || cutSize == 7);
-        assert(k <= cutSize);
+    template <int CutSize>
+    bool forbiddenCycleOneEdge(int a, int b, int k) const {
+        return forbidden_cycle_oneedge_memo_.get(cycleMemoIndex<CutSize>(a, b, k), [&] {
+            return calcForbiddenCycleOneEdge<CutSize>(a, b, k);
+        });
+    }
+
+    // forbiddenCycleOneEdge の計算
+    template <int CutSize>
+    bool calcForbiddenCycleOneEdge(int a, int b, int k) const {
+        assert(k <= CutSize);
         int b_ = a < b ? b : b + r_;
         int q = b_ - a;
 
         // D := C - P + Q + one edge
-        vector<int> Q(1+b_-a);
+        // Q はリングの頂点 b, b-1, ..., a を通るパス
+        VertexSet Q;
         for (int v = a;v < b_ + 1; v++) {
-            Q[v - a] = v % r_;
+            Q.set(v % r_);
         }
-        std::reverse(Q.begin(), Q.end());
-        auto [s, t] = sizeOfVertices(Q);
-        int sz = max(s - max(cutSize - k - 1, 0) + 1, 0) / 2 + t;
-        int l = cutSize - k + q + 1;
-        if (!(l == 7 && cutSize == 6) && 
+        auto [s, t] = sizeOfComponent(componentMask(Q, b, a));
+        int sz = std::max(s - std::max(CutSize - k - 1, 0) + 1, 0) / 2 + t;
+        int l = CutSize - k + q + 1;
+        if (!(l == 7 && CutSize == 6) && 
             isForbiddenCut(l, sz)) {
             return true;
         }
 
         assert(a != b);
-        const vector<vector<int>> &abpaths = all_paths_[a][b];
-        for (auto R : abpaths) {
-            int m = (int)R.size() - 1;
-
-            int number_in_ring = 0;
-            for (size_t i = 0;i < R.size() - 1; i++) {
-                if (R[i] < r_ && R[i + 1] < r_) number_in_ring++;
-            }
+        const PathStore &all_paths = allPaths();
+        for (size_t i : all_paths.indices(a * r_ + b)) {
+            const PathSummary &R = all_paths.summary(i);
+            int m = R.length;
+            int number_in_ring = R.number_in_ring;
             // + R の辺のうち 2 本以下を除いて ring の辺であり、 P + R + one edge が 7 サイクルで 6 サイクルの中にある
             // 場合は矛盾しているとは言えない。
             if (((m <= 2 || number_in_ring >= m - 2) && 
-                 k + m + 1 == 7 && cutSize == 6)) {
+                 k + m + 1 == 7 && CutSize == 6)) {
                 continue;
             }
 
             // E := P + R + one edge
-            auto [s, t] = sizeOfVertices(R);
-            int sz = max(s - max(k - 1, 0) + 1, 0) / 2 + t;
+            int s = R.ring_size, t = R.inside_size;
+            int sz = std::max(s - std::max(k - 1, 0) + 1, 0) / 2 + t;
             if (isForbiddenCut(k + m + 1, sz)) {
                 return true;
             }
@@ -1076,9 +1509,10 @@ struct Configuration {
         return false;
     }
 
-    // 長さが cutSize であるサイクルに囲われているときの length_onedge を計算する。
-    vector<vector<int>> calcLowerBoundLengthOuterPath(int cutSize) const {
-        vector<vector<int>> length(r_, vector<int>(r_, 0));
+    // 長さが CutSize であるサイクルに囲われているときの length_onedge を計算する。
+    template <int CutSize>
+    ByteMatrix calcLowerBoundLengthOuterPath(void) const {
+        ByteMatrix length(r_, r_, 0);
         for (int p = 0;p < r_; p++) {
             for (int q = 0;q < r_; q++) {
                 if (p == q) continue;
@@ -1088,7 +1522,7 @@ struct Configuration {
                 }
                 int k = 0;
                 while (1) {
-                    if (k > cutSize || !forbiddenCycle(p, q, k, cutSize)) {
+                    if (k > CutSize || !forbiddenCycle<CutSize>(p, q, k)) {
                         length[p][q] = k;
                         break;
                     }
@@ -1099,9 +1533,10 @@ struct Configuration {
         return length;
     }
 
-    // 長さが cutSize であるサイクルに囲われているときの length_onedge を計算する。
-    vector<vector<int>> calcLowerBoundLengthOuterPathOneEdge(int cutSize) const {
-        vector<vector<int>> length_oneedge(r_, vector<int>(r_, 0));
+    // 長さが CutSize であるサイクルに囲われているときの length_onedge を計算する。
+    template <int CutSize>
+    ByteMatrix calcLowerBoundLengthOuterPathOneEdge(void) const {
+        ByteMatrix length_oneedge(r_, r_, 0);
         for (int p = 0;p < r_; p++) {
             for (int q = 0;q < r_; q++) {
                 if (p == q) continue;
@@ -1111,7 +1546,7 @@ struct Configuration {
                 }
                 int k = 1;
                 while (1) {
-                    if (k > cutSize || !forbiddenCycleOneEdge(p, q, k, cutSize)) {
+                    if (k > CutSize || !forbiddenCycleOneEdge<CutSize>(p, q, k)) {
                         length_oneedge[p][q] = k;
                         break;
                     }
@@ -1122,11 +1557,11 @@ struct Configuration {
         return length_oneedge;
     }
 
-    bool isValid(const vector<int> &vs, const vector<int> &lens, const vector<bool> &onedge) const {
+    template <int CutSize>
+    bool isValid(std::span<const int> vs, std::span<const int> lens, std::span<const bool> onedge) const {
         assert(vs.size() == lens.size());
         assert(vs.size() == onedge.size());
-        int cutSize = std::accumulate(lens.begin(), lens.end(), 0);
-        assert(cutSize == 6 || cutSize == 7);
+        assert(std::accumulate(lens.begin(), lens.end(), 0) == CutSize);
         
         size_t m = vs.size();
         for (size_t i = 0;i < m; i++) {
@@ -1134,13 +1569,13 @@ struct Configuration {
                 continue;
             }
             if (onedge[i] || onedge[(i + 1) % m]) {
-                if (forbiddenCycleOneEdge(vs[i], vs[(i+1) % m], lens[i], cutSize) ||
-                    forbiddenCycleOneEdge(vs[(i+1) % m], vs[i], cutSize - lens[i], cutSize)) {
+                if (forbiddenCycleOneEdge<CutSize>(vs[i], vs[(i+1) % m], lens[i]) ||
+                    forbiddenCycleOneEdge<CutSize>(vs[(i+1) % m], vs[i], CutSize - lens[i])) {
                     return false;
                 }
             } else {
-                if (forbiddenCycle(vs[i], vs[(i+1) % m], lens[i], cutSize) ||
-                    forbiddenCycle(vs[(i+1) % m], vs[i], cutSize - lens[i], cutSize)) {
+                if (forbiddenCycle<CutSize>(vs[i], vs[(i+1) % m], lens[i]) ||
+                    forbiddenCycle<CutSize>(vs[(i+1) % m], vs[i], CutSize - lens[i])) {
                     return false;
                 }
             }
@@ -1148,52 +1583,68 @@ struct Configuration {
         return true;
     }
 
-    // 縮約後の component に含まれる頂点の数を計算する。
-    pair<int, int> vertexSizeAfterContract(const vector<int> &component, int cutSize) const {
+    bool isValid(std::span<const int> vs, std::span<const int> lens, std::span<const bool> onedge) const {
+        int cutSize = std::accumulate(lens.begin(), lens.end(), 0);
         assert(cutSize == 6 || cutSize == 7);
-        const vector<bool> &is_reductable_outside = cutSize == 6 ? is_reductable_outside6_ : is_reductable_outside7_;
+        return cutSize == 6 ? isValid<6>(vs, lens, onedge) : isValid<7>(vs, lens, onedge);
+    }
+
+    // 縮約後の component に含まれる頂点の数を計算する。
+    template <int CutSize>
+    std::pair<int, int> vertexSizeAfterContract(const VertexSet &component) const {
+        const std::vector<bool> &is_reductable_inside = isReductableInside();
+        const std::vector<bool> &is_reductable_outside = isReductableOutside<CutSize>();
 
         int s = 0; // ring
         int t = 0; // inside ring
-        for (int v : component) {
-            if (is_reductable_inside_[v] || is_reductable_outside[v]) {
-                continue;
+        component.forEach([&](int v) {
+            if (is_reductable_inside[v] || is_reductable_outside[v]) {
+                return;
             }
             if (v < r_ && representative_[v] == v) {
                 s++;
             } else if (v >= r_ && representative_[v] == v) {
                 t++;
             }
-        }
+        });
 
         return std::make_pair(s, t);
     }
 
-    // リングの頂点の集合 vs の頂点を順番に通るパスであって、vs[i], vs[i+1] (i=0,...,vs.size()-2) を
-    // 縮約後の最短路で結ぶようなものを考え、vs[0] と vs[-1] を conf の外側で結ぶ長さ k のパスと合わせて、
-    // 縮約後のグラフに既存のスナークに存在しないサイクルができていることを確認する。
-    // rev = false のときは、vs[0]+1, vs[0]+2, ... , vs[-1]-1 を含む連結成分を考える。
-    // rev = true のときは、true のときとは逆側を含む連結成分を考える。
-    bool forbiddenVertexSize(const vector<int> &vs, int k, int cutSize, bool rev=false) const {
+    // リングの頂点 vs[0], vs[1], ... を順に縮約後の最短路 (shortestPaths(vs[i], vs[i+1], true)[0]) で結んだパスの
+    // 頂点を path に加え、縮約後のパスの長さを返す。
+    int chainPath(std::span<const int> vs, VertexSet &path) const {
         assert(vs.size() >= 2);
-
-        int l = k;
-        vector<int> path = {vs[0]};
+        int l = 0;
+        path.set(vs[0]);
         for (size_t i = 0;i < vs.size() - 1; i++) {
             assert(vs[i] < r_);
             assert(dist_contracted_[vs[i]][vs[i + 1]] <= 1);
             l += dist_contracted_[vs[i]][vs[i + 1]];
-            vector<int> path_i = shortestPaths(vs[i], vs[i + 1], true)[0];
-            path.insert(path.end(), path_i.begin() + 1, path_i.end());
+            for (int v : shortestPaths(vs[i], vs[i + 1], true)[0]) {
+                path.set(v);
+            }
         }
         assert(vs.back() < r_);
+        return l;
+    }
+
+    // リングの頂点の集合 vs の頂点を順番に通るパスであって、vs[i], vs[i+1] (i=0,...,vs.size()-2) を
+    // 縮約後の最短路で結ぶようなものを考え、vs[0] と vs[-1] を conf の外側で結ぶ長さ k のパスと合わせて、
+    // 縮約後のグラフに既存のスナークに存在しないサイクルができていることを確認する。
+    // rev = false のときは、vs[0]+1, vs[0]+2, ... , vs[-1]-1 を含む連結成分を考える。
+    // rev = true のときは、true のときとは逆側を含む連結成分を考える。
+    template <int CutSize>
+    bool forbiddenVertexSize(std::span<const int> vs, int k, bool rev=false) const {
+        VertexSet path;
+        int l = k + chainPath(vs, path);
+        int p = vs.front(), q = vs.back();
         if (rev) {
-            std::reverse(path.begin(), path.end());
+            std::swap(p, q);
         }
 
-        vector<int> component = getComponent(path);
-        auto [s, t] = vertexSizeAfterContract(component, cutSize);
-        int sz = max(s - (k-1) + 1, 0) / 2 + t;
+        auto [s, t] = vertexSizeAfterContract<CutSize>(componentMask(path, p, q));
+        int sz = std::max(s - (k-1) + 1, 0) / 2 + t;
 
         return (l == 4 && sz > 0) || (l == 5 && sz > 1) || (l == 6 && sz > 2);
     }
@@ -1202,45 +1653,39 @@ struct Configuration {
     // 縮約後の最短路で結ぶようなものと vs2 でも同様のパスを考えて、
     // それぞれ vs1[-1] と vs2[0], vs2[-1] と vs1[0] を結ぶ長さ k1, k2 のパスがあるとき、
     // 縮約後のグラフに既存のスナークに存在しないサイクルができていることを確認する。
-    bool forbiddenVertexSize(const vector<int> &vs1, const vector<int> &vs2, int k1, int k2, int cutSize) const {
-        int l = k1 + k2;
-        assert(vs1.size() >= 2);
-        vector<int> path1 = {vs1[0]};
-        for (size_t i = 0;i < vs1.size() - 1; i++) {
-            assert(vs1[i] < r_);
-            assert(dist_contracted_[vs1[i]][vs1[i + 1]] <= 1);
-            l += dist_contracted_[vs1[i]][vs1[i + 1]];
-            vector<int> path_i = shortestPaths(vs1[i], vs1[i + 1], true)[0];
-            path1.insert(path1.end(), path_i.begin() + 1, path_i.end());
-        }
-        assert(vs1.back() < r_);
-
-        assert(vs2.size() >= 2);
-        vector<int> path2 = {vs2[0]};
-        for (size_t i = 0;i < vs2.size() - 1; i++) {
-            assert(vs2[i] < r_);
-            assert(dist_contracted_[vs2[i]][vs2[i + 1]] <= 1);
-            l += dist_contracted_[vs2[i]][vs2[i + 1]];
-            vector<int> path_i = shortestPaths(vs2[i], vs2[i + 1], true)[0];
-            path2.insert(path2.end(), path_i.begin() + 1, path_i.end());
-        }
-        assert(vs2.back() < r_);
-
-        vector<int> component = getComponent(path1, path2);
-        auto [s, t] = vertexSizeAfterContract(component, cutSize);
-        int sz = max(s - max(k1+k2-2, 0) + 1, 0) / 2 + t;
+    template <int CutSize>
+    bool forbiddenVertexSize(std::span<const int> vs1, std::span<const int> vs2, int k1, int k2) const {
+        VertexSet path1, path2;
+        int l = k1 + k2 + chainPath(vs1, path1) + chainPath(vs2, path2);
+
+        // getComponent(path1, path2) と同じ頂点集合
+        VertexSet component = componentMask(path2, vs2.back(), vs2.front()) - componentMask(path1, vs1.front(), vs1.back());
+        auto [s, t] = vertexSizeAfterContract<CutSize>(component);
+        int sz = std::max(s - std::max(k1+k2-2, 0) + 1, 0) / 2 + t;
 
         return (l == 4 && sz > 0) || (l == 5 && sz > 1) || (l == 6 && sz > 2);
     }
 
+    bool forbiddenVertexSize(std::span<const int> vs, int k, int cutSize, bool rev=false) const {
+        assert(cutSize == 6 || cutSize == 7);
+        return cutSize == 6 ? forbiddenVertexSize<6>(vs, k, rev) : forbiddenVertexSize<7>(vs, k, rev);
+    }
+
+    bool forbiddenVertexSize(std::span<const int> vs1, std::span<const int> vs2, int k1, int k2, int cutSize) const {
+        assert(cutSize == 6 || cutSize == 7);
+        return cutSize == 6 ? forbiddenVertexSize<6>(vs1, vs2, k1, k2) : forbiddenVertexSize<7>(vs1, vs2, k1, k2);
+    }
+
     // 7 サイクルの中の conf の辺を縮約したあと、そのサイクルの外の頂点を含む 2,3-cut reduction は起きないとしたとき、
     // 次数 7 が 1 点だけの状況になっているかをチェックする。
     bool checkDegree7(void) const {
-        vector<set<int>> VtoV_contracted(n_);
+        const std::vector<bool> &is_reductable_inside = isReductableInside();
+        const std::vector<bool> &is_reductable_outside7 = isReductableOutside<7>();
+        std::vector<std::set<int>> VtoV_contracted(n_);
         for (int v = 0;v < n_; v++) {
-            if (is_reductable_inside_[v] || is_reductable_outside7_[v]) continue;
-            for (int u : VtoV_[v]) {
-                if (is_reductable_inside_[u] || is_reductable_outside7_[u]) continue;
+            if (is_reductable_inside[v] || is_reductable_outside7[v]) continue;
+            for (int u : graph_.neighbors(v)) {
+                if (is_reductable_inside[u] || is_reductable_outside7[u]) continue;
                 VtoV_contracted[representative_[v]].insert(representative_[u]);
                 VtoV_contracted[representative_[u]].insert(representative_[v]);
             }
@@ -1249,7 +1694,7 @@ struct Configuration {
         int n_ring = 0, n_conf = 0;
         bool not_deg7 = false;
         for (int v = 0;v < n_; v++) {
-            if (is_reductable_inside_[v] || is_reductable_outside7_[v]) continue;
+            if (is_reductable_inside[v] || is_reductable_outside7[v]) continue;
             if (v < r_ && representative_[v] == v) n_ring++;
             if (v >= r_ && representative_[v] == v) {
                 n_conf++;
@@ -1264,12 +1709,13 @@ struct Configuration {
 };
 
 
-// 双対グラフの辺で edgeids の id を持つ辺に対応する主グラフの辺を返す。
-vector<pair<int, int>> edgeFromId(const Configuration &conf, const vector<int> &edgeids) {
+// 双対グラフの辺の番号付け
+// i 番目の要素が id i の辺に対応する主グラフの辺。id 0, ..., r - 1 はリングの辺。
+inline std::vector<std::pair<int, int>> dualEdges(const Configuration &conf) {
     auto is3Cycle = [&] (int x, int y, int z) {
-        return conf.VtoV_.at(x).count(y) && conf.VtoV_.at(y).count(z) && conf.VtoV_.at(z).count(x);
+        return conf.graph_.adjacent(x, y) && conf.graph_.adjacent(y, z) && conf.graph_.adjacent(z, x);
     };
-    set<tuple<int, int, int>> triangles;
+    std::set<std::tuple<int, int, int>> triangles;
     for (int i = 0; i < conf.n_; i++) {
         for (int j = 0; j < i; j++) {
             for (int k = 0; k < j; k++) {
@@ -1280,8 +1726,8 @@ vector<pair<int, int>> edgeFromId(const Configuration &conf, const vector<int> &
         }
     }
 
-    map<pair<int, int>, int> indexOfEdge;
-    vector<pair<int, int>> edgeOfIndex;
+    std::map<std::pair<int, int>, int> indexOfEdge;
+    std::vector<std::pair<int, int>> edgeOfIndex;
     int counter = 0;
     auto addEdge = [&] (int x, int y) {
         if (x > y) std::swap(x, y);
@@ -1300,24 +1746,36 @@ vector<pair<int, int>> edgeFromId(const Configuration &conf, const vector<int> &
         addEdge(c, a);
     }
 
-    vector<pair<int, int>> primal_edges(edgeids.size());
+    return edgeOfIndex;
+}
+
+// 双対グラフの辺で edgeids の id を持つ辺に対応する主グラフの辺を返す。
+// 範囲外の id があれば std::runtime_error を投げる。
+inline std::vector<std::pair<int, int>> edgeFromId(const Configuration &conf, const std::vector<int> &edgeids) {
+    std::vector<std::pair<int, int>> edgeOfIndex = dualEdges(conf);
+    std::vector<std::pair<int, int>> primal_edges(edgeids.size());
     for (size_t i = 0;i < edgeids.size(); i++) {
+        if (edgeids[i] < 0 || edgeids[i] >= (int)edgeOfIndex.size()) {
+            spdlog::critical("Invalid edge id {} (expected 0 <= id < {})", edgeids[i], edgeOfIndex.size());
+            throw std::runtime_error(fmt::format("Invalid edge id {} (expected 0 <= id < {})", edgeids[i],
+                                                 edgeOfIndex.size()));
+        }
         primal_edges[i] = edgeOfIndex[edgeids[i]];
     }
     
     return primal_edges;
 }
 
-string join(const vector<pair<int, int>> &edges) {
-    string res = "";
+inline std::string join(const std::vector<std::pair<int, int>> &edges) {
+    std::string res = "";
     for (const auto &e : edges) {
         res += fmt::format("({}, {}), ", e.first, e.second);
     }
     return res;
 }
 
-vector<int> reductableVertices(int n, const vector<bool> &is_reductable) {
-    vector<int> reductable_vertices;
+inline std::vector<int> reductableVertices(int n, const std::vector<bool> &is_reductable) {
+    std::vector<int> reductable_vertices;
     for (int v = 0;v < n; v++) {
         if (is_reductable[v]) {
             reductable_vertices.push_back(v);
@@ -1326,842 +1784,250 @@ vector<int> reductableVertices(int n, const vector<bool> &is_reductable) {
     return reductable_vertices;
 }
 
-// a,b は ring にその順に並んでいる頂点
-// dist[a][b] = d0
-vector<pair<int, int>> find_ab(int d0, int n, int r, const vector<vector<int>> &contract_dist) {
-    vector<pair<int, int>> abs;
-    for (int a = 0;a < r; a++) {
-        for (int b = a+1;b < r; b++) {
-            if (contract_dist[a][b] == d0) {
-                abs.emplace_back(a, b);
-            }
-        }
-    }
-    return abs;
+// 危険なケースをログに出力して数える。
+template <typename... Args>
+void reportDangerous(int &num_dangerous, fmt::format_string<Args...> format, Args &&...args) {
+    LOG_INFO(format, std::forward<Args>(args)...);
+    num_dangerous++;
 }
 
-// a,b,c は ring にその順に並んでいる頂点
-// dist[a][b] = d0
-// dist[b][c] = d1
-vector<tuple<int, int, int>> find_ab_bc(int d0, int d1, int n, int r, const vector<vector<int>> &contract_dist) {
-    vector<tuple<int, int, int>> abcs;
-    for (int a = 0;a < r; a++) {
-        for (int b = a+1;b < r; b++) {
-            if (contract_dist[a][b] == d0) {
-                for (int c = a+1;c < b; c++) {
-                    if (contract_dist[a][c] == d1) {
-                        abcs.emplace_back(b, a, c);
-                    }
-                }
-                for (int c = b+1;c < a+r; c++) {
-                    if (contract_dist[b][c%r] == d1) {
-                        abcs.emplace_back(a, b, c%r);
-                    }
-                }
-            }
-        }
+// リングの頂点の組 tuple が pattern のカットになりうるかを判定する。
+// vs には isValid に渡した頂点 (tuple を pattern.order で並べ替えたもの) が入る。
+template <int CutSize>
+bool isDangerousCut(const Configuration &conf, const CutPattern &pattern, const int *tuple,
+                    std::array<int, MaxRingTupleSize> &vs) {
+    assert(pattern.cutSize() == CutSize);
+    size_t m = pattern.size;
+    for (size_t i = 0;i < m; i++) {
+        vs[i] = tuple[pattern.order[i]];
+    }
+    if (!conf.isValid<CutSize>(std::span<const int>(vs.data(), m), std::span<const int>(pattern.lens.data(), m),
+                               std::span<const bool>(pattern.onedge.data(), m))) {
+        return false;
     }
-    std::sort(abcs.begin(), abcs.end());
-    abcs.erase(std::unique(abcs.begin(), abcs.end()), abcs.end());
-    return abcs;
-}
-
-// a,b,c は ring にその順に並んでいる頂点
-// dist[a][b] = d0
-// dist[a][c] = d1
-// dist[b][c] = d2
-vector<tuple<int, int, int>> find_ab_ac_bc(int d0, int d1, int d2, int n, int r, const vector<vector<int>> &contract_dist) {
-    vector<tuple<int, int, int>> abcs;
-    for (int a = 0;a < r; a++) {
-        for (int b = a+1;b < r; b++) {
-            if (contract_dist[a][b] == d0) {
-                for (int c = a+1;c < b; c++) {
-                    if (contract_dist[b][c] == d1 && contract_dist[a][c] == d2) {
-                        abcs.emplace_back(b, a, c);
-                    }
-                }
-                for (int c = b+1;c < a+r; c++) {
-                    if (contract_dist[a][c%r] == d1 && contract_dist[b][c%r] == d2) {
-                        abcs.emplace_back(a, b, c%r);
-                    }
-                }
-            }
+    switch (pattern.vertex_size) {
+    case VertexSizeCheck::None:
+        return true;
+    case VertexSizeCheck::Single: {
+        std::array<int, MaxRingTupleSize> ws;
+        for (size_t i = 0;i < m; i++) {
+            ws[i] = tuple[pattern.vertex_order[i]];
         }
+        return !conf.forbiddenVertexSize<CutSize>(std::span<const int>(ws.data(), m), pattern.k1, pattern.rev);
     }
-    std::sort(abcs.begin(), abcs.end());
-    abcs.erase(std::unique(abcs.begin(), abcs.end()), abcs.end());
-    return abcs;
-}
-
-// a,b,c,d は ring にその順に並んでいる頂点
-// dist[a][b] = d0
-// dist[c][d] = d1
-vector<tuple<int, int, int, int>> find_ab_cd(int d0, int d1, int n, int r, const vector<vector<int>> &contract_dist) {
-    vector<tuple<int, int, int, int>> abcds;
-    for (int a = 0;a < r; a++) {
-        for (int b = a+1;b < r; b++) {
-            if (contract_dist[a][b] == d0) {
-                for (int c = b+1;c < a+r; c++) {
-                    for (int d = c+1;d < a+r; d++) {
-                        if (contract_dist[c%r][d%r] == d1) {
-                            abcds.emplace_back(a, b, c%r, d%r);
-                        }
-                    }
-                }
-                for (int c = a+1;c < b; c++) {
-                    for (int d = c+1;d < b; d++) {
-                        if (contract_dist[c][d] == d1) {
-                            abcds.emplace_back(b, a, c, d);
-                        }
-                    }
-                }
-            }
-        }
+    case VertexSizeCheck::Pair:
+        return !conf.forbiddenVertexSize<CutSize>(std::span<const int>(tuple, pattern.split),
+                                                  std::span<const int>(tuple + pattern.split, m - pattern.split),
+                                                  pattern.k1, pattern.k2);
     }
-    std::sort(abcds.begin(), abcds.end());
-    abcds.erase(std::unique(abcds.begin(), abcds.end()), abcds.end());
-    return abcds;
+    return true;
 }
 
-// a,b,c,d は ring にその順に並んでいる頂点
-// dist[a][b] = d0
-// dist[b][c] = d1
-// dist[c][d] = d2
-vector<tuple<int, int, int, int>> find_ab_bc_cd(int d0, int d1, int d2, int n, int r, const vector<vector<int>> &contract_dist) {
-    vector<tuple<int, int, int, int>> abcds;
-    for (int a = 0;a < r; a++) {
-        for (int b = a+1;b < r; b++) {
-            if (contract_dist[a][b] == d0) {
-                for (int c = b+1;c < a+r; c++) {
-                    if (contract_dist[b][c%r] == d1) {
-                        for (int d = c+1;d < a+r; d++) {
-                            if (contract_dist[c%r][d%r] == d2) {
-                                abcds.emplace_back(a, b, c%r, d%r);
-                            }
-                        }
-                    }
-                }
-                for (int c = a+1;c < b; c++) {
-                    if (contract_dist[a][c] == d1) {
-                        for (int d = c+1;d < b; d++) {
-                            if (contract_dist[c][d] == d2) {
-                                abcds.emplace_back(b, a, c, d);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-    std::sort(abcds.begin(), abcds.end());
-    abcds.erase(std::unique(abcds.begin(), abcds.end()), abcds.end());
-    return abcds;
+inline bool isDangerousCut(const Configuration &conf, const CutPattern &pattern, const int *tuple,
+                    std::array<int, MaxRingTupleSize> &vs) {
+    return pattern.cutSize() == 6 ? isDangerousCut<6>(conf, pattern, tuple, vs) : isDangerousCut<7>(conf, pattern, tuple, vs);
 }
 
-// a,b,c,d,e は ring にその順に並んでいる頂点
-// dist[a][b] = d0
-// dist[b][c] = d1
-// dist[d][e] = d2
-vector<tuple<int, int, int, int, int>> find_ab_bc_de(int d0, int d1, int d2, int n, int r, const vector<vector<int>> &contract_dist) {
-    vector<tuple<int, int, int, int, int>> abcdes;
-    for (int a = 0;a < r; a++) {
-        for (int b = a+1;b < r; b++) {
-            if (contract_dist[a][b] == d0) {
-                for (int c = b+1;c < a+r; c++) {
-                    if (contract_dist[b][c%r] == d1) {
-                        for (int d = c+1;d < a+r; d++) {
-                            for (int e = d+1;e < a+r; e++) {
-                                if (contract_dist[d%r][e%r] == d2) {
-                                    abcdes.emplace_back(a, b, c%r, d%r, e%r);
-                                }
-                            }
-                        }
-                    }
-                }
-                for (int c = a+1;c < b; c++) {
-                    if (contract_dist[a][c] == d1) {
-                        for (int d = c+1;d < b; d++) {
-                            for (int e = d+1;e < b; e++) {
-                                if (contract_dist[d][e] == d2) {
-                                    abcdes.emplace_back(b, a, c, d, e);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-    std::sort(abcdes.begin(), abcdes.end());
-    abcdes.erase(std::unique(abcdes.begin(), abcdes.end()), abcdes.end());
-    return abcdes;
+// filename の configuration を読み込む。
+// cache_dir が空でなければ、縮約によらない前計算の結果を .conf の内容のハッシュをキーにして cache_dir に保存し、
+// 次からはそれを読み込む。
+inline Configuration loadConfiguration(const std::string &filename, Parallelism parallelism = {}, const std::string &cache_dir = "") {
+    if (cache_dir.empty()) {
+        return Configuration::readConfFile(filename, parallelism);
+    }
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs) {
+        spdlog::critical("Failed to open {} ", filename);
+        throw std::runtime_error("Failed to open" + filename);
+    }
+    std::stringstream text;
+    text << ifs.rdbuf();
+    uint64_t hash = fnv1a(text.view());
+    ConfCache cache(cache_dir);
+    try {
+        if (std::optional<MappedFile> mapped = cache.load(hash)) {
+            BinaryReader reader = ConfCache::body(*mapped);
+            spdlog::debug("load {} from {}", filename, cache.path(hash));
+            return Configuration::readTables(reader, parallelism);
+        }
+    } catch (const std::runtime_error &e) {
+        spdlog::warn("Ignored the broken cache {} ({})", cache.path(hash), e.what());
+    }
+    Configuration conf = Configuration::readConf(text, filename, parallelism);
+    BinaryWriter writer;
+    conf.writeTables(writer);
+    try {
+        cache.store(hash, writer);
+        spdlog::debug("save {} to {}", filename, cache.path(hash));
+    } catch (const std::runtime_error &e) {
+        spdlog::warn("Failed to save the cache {} ({})", cache.path(hash), e.what());
+    }
+    return conf;
 }
 
-void check(const string &filename, const vector<int> &edgeids) {
-    spdlog::info("filename: {}", filename);
-    Configuration conf = Configuration::readConfFile(filename);
-    vector<pair<int, int>> edges = edgeFromId(conf, edgeids);
-
-    conf.setContract(edges);
-
-    vector<vector<int>> contract_dist = conf.WF(true);
-
-    vector<pair<int, int>> ab0s = find_ab(0, conf.n_, conf.r_, contract_dist);
-    vector<pair<int, int>> ab1s = find_ab(1, conf.n_, conf.r_, contract_dist);
-
-    vector<tuple<int, int, int>> ab0_bc1s = find_ab_bc(0, 1, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int>> ab1_bc0s = find_ab_bc(1, 0, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int>> ab1_bc1s = find_ab_bc(1, 1, conf.n_, conf.r_, contract_dist);
-
-    vector<tuple<int, int, int>> ab0_ac0_bc0s = find_ab_ac_bc(0, 0, 0, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int>> ab0_ac1_bc1s = find_ab_ac_bc(0, 1, 1, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int>> ab1_ac1_bc1s = find_ab_ac_bc(1, 1, 1, conf.n_, conf.r_, contract_dist);
-
-    vector<tuple<int, int, int, int>> ab0_cd0s = find_ab_cd(0, 0, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int, int>> ab0_cd1s = find_ab_cd(0, 1, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int, int>> ab1_cd1s = find_ab_cd(1, 1, conf.n_, conf.r_, contract_dist);
-    
-    vector<tuple<int, int, int, int>> ab0_bc0_cd0s = find_ab_bc_cd(0, 0, 0, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int, int>> ab0_bc0_cd1s = find_ab_bc_cd(0, 0, 1, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int, int>> ab0_bc1_cd0s = find_ab_bc_cd(0, 1, 0, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int, int>> ab0_bc1_cd1s = find_ab_bc_cd(0, 1, 1, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int, int>> ab1_bc0_cd0s = find_ab_bc_cd(1, 0, 0, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int, int>> ab1_bc0_cd1s = find_ab_bc_cd(1, 0, 1, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int, int>> ab1_bc1_cd0s = find_ab_bc_cd(1, 1, 0, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int, int>> ab1_bc1_cd1s = find_ab_bc_cd(1, 1, 1, conf.n_, conf.r_, contract_dist);
-
-    vector<tuple<int, int, int, int, int>> ab0_bc0_de0s = find_ab_bc_de(0, 0, 0, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int, int, int>> ab0_bc1_de0s = find_ab_bc_de(0, 1, 0, conf.n_, conf.r_, contract_dist);
-    vector<tuple<int, int, int, int, int>> ab1_bc0_de0s = find_ab_bc_de(1, 0, 0, conf.n_, conf.r_, contract_dist);
-
-    // check loop except two difficutl types of loops
-    conf.canHaveContractibleLoop();
-
-    // 6cut-1
-    for (auto [a, b]: ab0s) {
-        if (conf.isValid(vector<int>{a, b}, vector<int>{2, 4}, vector<bool>{false, false})
-            && !conf.forbiddenVertexSize(vector<int>{b, a}, 4, 6)) {
-            spdlog::info("6cut-1 (24) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-        if (conf.isValid(vector<int>{a, b}, vector<int>{4, 2}, vector<bool>{false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, 4, 6)) {
-            spdlog::info("6cut-1 (42) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-    }
-
-    // 6cut-2
-    for (auto [a, b, c, d]: ab0_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{false, false, false, false})) {
-            spdlog::info("6cut-2 (2121) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-
-    // 6cut-3
-    for (auto [a, b, c]: ab0_ac0_bc0s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 2}, vector<bool>{false, false, false})) {
-            spdlog::info("6cut-3 (222) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-
-    // 6cut-4
-    for (auto [a, b, c, d]: ab0_cd1s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{false, false, false, false})) {
-            spdlog::info("6cut-4 (2121) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{true, false, false, false})) {
-            spdlog::info("6cut-4 (2121-1) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{false, true, false, false})) {
-            spdlog::info("6cut-4 (2121-2) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{false, false, true, false})) {
-            spdlog::info("6cut-4 (2121-3) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{false, false, false, true})) {
-            spdlog::info("6cut-4 (2121-4) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-
-    // 6cut-5
-    for (auto [a, b, c]: ab0_ac1_bc1s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 2}, vector<bool>{false, false, false})) {
-            spdlog::info("6cut-5 (222) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-    for (auto [a, b, c]: ab0_ac0_bc0s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 2}, vector<bool>{true, false, false})) {
-            spdlog::info("6cut-5 (222-1) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 2}, vector<bool>{false, true, false})) {
-            spdlog::info("6cut-5 (222-2) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 2}, vector<bool>{false, false, true})) {
-            spdlog::info("6cut-5 (222-3) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-
-    // 6cut-6
-    for (auto [a, b]: ab0s) {
-        if (conf.isValid(vector<int>{a, b}, vector<int>{3, 3}, vector<bool>{false, false})) {
-            spdlog::info("6cut-6 (33) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-    }
-
-    // 6cut-7
-    for (auto [a, b]: ab1s) {
-        if (conf.isValid(vector<int>{a, b}, vector<int>{2, 4}, vector<bool>{false, false})
-            && !conf.forbiddenVertexSize(vector<int>{b, a}, 4, 6)) {
-            spdlog::info("6cut-7 (24) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-        if (conf.isValid(vector<int>{a, b}, vector<int>{4, 2}, vector<bool>{false, false}) 
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, 4, 6) ) {
-            spdlog::info("6cut-7 (42) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-    }
-    for (auto [a, b]: ab0s) {
-        if (conf.isValid(vector<int>{a, b}, vector<int>{2, 4}, vector<bool>{true, false}) 
-            && !conf.forbiddenVertexSize(vector<int>{b, a}, 5, 6)) {
-            spdlog::info("6cut-7 (24-1) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-        if (conf.isValid(vector<int>{a, b}, vector<int>{4, 2}, vector<bool>{true, false}) 
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, 5, 6)) {
-            spdlog::info("6cut-7 (42-1) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-        if (conf.isValid(vector<int>{a, b}, vector<int>{2, 4}, vector<bool>{false, true}) 
-            && !conf.forbiddenVertexSize(vector<int>{b, a}, 5, 6)) {
-            spdlog::info("6cut-7 (24-2) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-        if (conf.isValid(vector<int>{a, b}, vector<int>{4, 2}, vector<bool>{false, true}) 
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, 5, 6)) {
-            spdlog::info("6cut-7 (42-2) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-    }
-
-    // 6cut-8
-    for (auto [a, b, c, d]: ab1_cd1s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{false, false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 1, 6)) {
-            spdlog::info("6cut-8 (2121) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_cd1s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{true, false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 1, 6)) {
-            spdlog::info("6cut-8 (2121-1) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{false, true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 1, 6)) {
-            spdlog::info("6cut-8 (2121-2) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{true, false, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 3, 1, 6)) {
-            spdlog::info("6cut-8 (2121-14) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{false, true, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 3, 1, 6)) {
-            spdlog::info("6cut-8 (2121-23) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{true, false, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 2, 6)) {
-            spdlog::info("6cut-8 (2121-13) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 1}, vector<bool>{false, true, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 2, 6)) {
-            spdlog::info("6cut-8 (2121-24) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-
-    // 6cut-9
-    for (auto [a, b, c]: ab1_bc1s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 2}, vector<bool>{false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, 2, 6, true)) {
-            spdlog::info("6cut-9 (222) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-    for (auto [a, b, c]: ab0_bc1s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 2}, vector<bool>{true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, 3, 6, true)) {
-            spdlog::info("6cut-9 (222-1) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-    for (auto [a, b, c]: ab1_bc0s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 2}, vector<bool>{false, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, 3, 6, true)) {
-            spdlog::info("6cut-9 (222-3) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-    for (auto [a, b, c]: ab0_ac0_bc0s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 2}, vector<bool>{true, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, 4, 6, true)) {
-            spdlog::info("6cut-9 (222-13) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-        if (conf.isValid(vector<int>{b, c, a}, vector<int>{2, 2, 2}, vector<bool>{true, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{b, c, a}, 4, 6, true)) {
-            spdlog::info("6cut-9 (222-13) ({}, {}, {}) is dangerous in {}", b, c, a, filename);
-        }
-        if (conf.isValid(vector<int>{c, a, b}, vector<int>{2, 2, 2}, vector<bool>{true, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{c, a, b}, 4, 6, true)) {
-            spdlog::info("6cut-9 (222-13) ({}, {}, {}) is dangerous in {}", c, a, b, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 0}, vector<bool>{true, false, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 2, 6)) {
-            spdlog::info("6cut-9 (2220-14) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 0, 2, 2}, vector<bool>{false, true, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 2, 6)) {
-            spdlog::info("6cut-9 (2022-23) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-
-    // 6cut-10
-    for (auto [a, b, c]: ab1_ac1_bc1s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 2}, vector<bool>{false, false, false})) {
-            spdlog::info("6cut-10 (222) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_bc1_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 0}, vector<bool>{true, false, false, true})) {
-            spdlog::info("6cut-10 (2220-14) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-
-    // 7cut-1
-    for (auto [a, b]: ab0s) {
-        if (conf.isValid(vector<int>{a, b}, vector<int>{2, 5}, vector<bool>{false, false})
-            && !conf.forbiddenVertexSize(vector<int>{b, a}, 5, 7)) {
-            spdlog::info("7cut-1 (25) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-        if (conf.isValid(vector<int>{a, b}, vector<int>{5, 2}, vector<bool>{false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, 5, 7)) {
-            spdlog::info("7cut-1 (52) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-    }
-
-    // 7cut-2
-    for (auto [a, b, c, d]: ab0_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{3, 1, 2, 1}, vector<bool>{false, false, false, false})) {
-            spdlog::info("7cut-2 (3121) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 3, 1}, vector<bool>{false, false, false, false})) {
-            spdlog::info("7cut-2 (2131) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
+// 縮約辺を設定した conf のカットのチェックを、全ての危険なケースについて行う。
+inline void checkAllCuts(const Configuration &conf, const std::string &filename, CheckResult &result) {
+    std::array<std::vector<int>, NUM_TUPLE_FAMILIES> tuples;
+    {
+        ScopedTimer timer(conf.profile(), PhaseTupleIndex);
+        RingTupleIndex index(conf.r_, conf.contractedDistance());
+        for (size_t f = 0;f < NUM_TUPLE_FAMILIES; f++) {
+            tuples[f] = index.find(tuple_families[f]);
         }
     }
 
-    // 7cut-3
-    for (auto [a, b, c, d]: ab0_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{false, false, false, false})) {
-            spdlog::info("7cut-3 (2122) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, false, false, false})) {
-            spdlog::info("7cut-3 (2221) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-
-    // 7cut-4
-    for (auto [a, b, c]: ab0_ac0_bc0s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{3, 2, 2}, vector<bool>{false, false, false})) {
-            spdlog::info("7cut-4 (322) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 3, 2}, vector<bool>{false, false, false})) {
-            spdlog::info("7cut-4 (232) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 3}, vector<bool>{false, false, false})) {
-            spdlog::info("7cut-4 (223) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-
-    // 7cut-5
-    for (auto [a, b, c]: ab0_bc1s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 3}, vector<bool>{false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, 3, 7, true)) {
-            spdlog::info("7cut-5 (223) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-    for (auto [a, b, c]: ab1_bc0s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 3}, vector<bool>{false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, 3, 7, true)) {
-            spdlog::info("7cut-5 (223) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-    for (auto [a, b, c]: ab0_ac0_bc0s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 3}, vector<bool>{true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, 4, 7, true)) {
-            spdlog::info("7cut-5 (223-1) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-        if (conf.isValid(vector<int>{b, c, a}, vector<int>{2, 2, 3}, vector<bool>{true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{b, c, a}, 4, 7, true)) {
-            spdlog::info("7cut-5 (223-1) ({}, {}, {}) is dangerous in {}", b, c, a, filename);
-        }
-        if (conf.isValid(vector<int>{c, a, b}, vector<int>{2, 2, 3}, vector<bool>{true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{c, a, b}, 4, 7, true)) {
-            spdlog::info("7cut-5 (223-1) ({}, {}, {}) is dangerous in {}", c, a, b, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{3, 2, 2}, vector<bool>{true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{b, c, a}, 4, 7, true)) {
-            spdlog::info("7cut-5 (223-1) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-        if (conf.isValid(vector<int>{b, c, a}, vector<int>{3, 2, 2}, vector<bool>{true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{c, a, b}, 4, 7, true)) {
-            spdlog::info("7cut-5 (223-1) ({}, {}, {}) is dangerous in {}", b, c, a, filename);
-        }
-        if (conf.isValid(vector<int>{c, a, b}, vector<int>{3, 2, 2}, vector<bool>{true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, 4, 7, true)) {
-            spdlog::info("7cut-5 (223-1) ({}, {}, {}) is dangerous in {}", c, a, b, filename);
-        }
-    }
-
-    // 7cut-6
-    for (auto [a, b, c, d]: ab0_cd1s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{false, false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 2, 7)) {
-            spdlog::info("7cut-6 (2122) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 2, 7)) {
-            spdlog::info("7cut-6 (2221) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{true, false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 3, 7)) {
-            spdlog::info("7cut-6 (2122-1) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 3, 7)) {
-            spdlog::info("7cut-6 (2221-2) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, false, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 3, 7)) {
-            spdlog::info("7cut-6 (2221-3) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{false, false, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 3, 7)) {
-            spdlog::info("7cut-6 (2122-4) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{true, false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 2, 7)) {
-            spdlog::info("7cut-6 (2221-1) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{false, true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 2, 7)) {
-            spdlog::info("7cut-6 (2122-2) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{false, false, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 2, 7)) {
-            spdlog::info("7cut-6 (2122-3) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, false, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 2, 7)) {
-            spdlog::info("7cut-6 (2221-4) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
+    // check loop except two difficutl types of loops
+    {
+        ScopedTimer timer(conf.profile(), PhaseContractibleLoop);
+        result.num_dangerous = conf.canHaveContractibleLoop(&result.findings);
+    }
+
+    // 6cut-1, ..., 7cut-15
+    std::optional<ScopedTimer> timer(std::in_place, conf.profile(), PhaseCutPatterns);
+    std::array<int, MaxRingTupleSize> vs;
+    size_t begin = 0;
+    for (const CutPatternLoop &loop : cut_pattern_loops) {
+        const std::vector<int> &family = tuples[loop.family];
+        size_t size = tuple_families[loop.family].size;
+        for (size_t i = 0;i < family.size(); i += size) {
+            for (size_t p = begin;p < begin + loop.num_patterns; p++) {
+                if (isDangerousCut(conf, cut_patterns[p], &family[i], vs)) {
+                    reportDangerous(result.num_dangerous, "{} ({}) is dangerous in {}",
+                                    cut_patterns[p].label, fmt::join(vs.begin(), vs.begin() + size, ", "), filename);
+                    result.findings.push_back({cut_patterns[p].label, std::vector<int>(vs.begin(), vs.begin() + size),
+                                               cut_patterns[p].cutSize()});
+                }
+            }
         }
+        begin += loop.num_patterns;
     }
 
-    // 7cut-7
-    for (auto [a, b, c, d]: ab0_bc1_cd1s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, false, false, false})) {
-            spdlog::info("7cut-7 (2221) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab1_bc1_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, false, false, false})) {
-            spdlog::info("7cut-7 (2221) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_bc1_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{true, false ,false, false})) {
-            spdlog::info("7cut-7 (2221-1) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, false ,false, true})) {
-            spdlog::info("7cut-7 (2221-4) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d, e]: ab0_bc0_de0s) {
-        if (conf.isValid(vector<int>{a, b, c, d, e}, vector<int>{2, 2, 0, 2, 1}, vector<bool>{false, false, true, true, false})) {
-            spdlog::info("7cut-7 (22021-34) ({}, {}, {}, {}, {}) is dangerous in {}", a, b, c, d, e, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d, e}, vector<int>{2, 2, 1, 2, 0}, vector<bool>{true, false, false, false, true})) {
-            spdlog::info("7cut-7 (22120-15) ({}, {}, {}, {}, {}) is dangerous in {}", a, b, c, d, e, filename);
-        }
+    // 7cut-16
+    timer.emplace(conf.profile(), PhaseDegree7);
+    if (!conf.checkDegree7()) {
+        reportDangerous(result.num_dangerous, "7cut-16 (degree 7 in 7-cycle) is dangerous in {}", filename);
+        result.findings.push_back({"7cut-16 (degree 7 in 7-cycle)", {}, 7});
     }
+}
 
-    // 7cut-8
-    for (auto [a, b, c, d]: ab1_bc0_cd1s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, false, false, false})) {
-            spdlog::info("7cut-8 (2221) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_bc0_cd1s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{true, false, false, false})) {
-            spdlog::info("7cut-8 (2221-1) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab1_bc0_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, false, false, true})) {
-            spdlog::info("7cut-8 (2221-4) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
+// 縮約辺を設定した conf のカットのチェックを、軽いものから最初の危険なケースが見つかるまで行う。
+// 組の族は初めて使うときに列挙するので、危険なケースが見つかった後の族は列挙しない。
+// checkDegree7 は 2,3-cut reduction で削除される頂点集合を使って重いので最後に調べる。
+inline void checkFirstDanger(const Configuration &conf, const std::string &filename, CheckResult &result) {
+    {
+        ScopedTimer timer(conf.profile(), PhaseContractibleLoop);
+        result.num_dangerous = conf.canHaveContractibleLoop(&result.findings, StopPolicy::FirstDanger);
     }
-    for (auto [a, b, c, d]: ab0_bc0_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{true, false, false, true})) {
-            spdlog::info("7cut-8 (2221-14) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{b, c, d, a}, vector<int>{2, 2, 2, 1}, vector<bool>{true, false, false, true})) {
-            spdlog::info("7cut-8 (2221-14) ({}, {}, {}, {}) is dangerous in {}", b, c, d, a, filename);
-        }
-        if (conf.isValid(vector<int>{c, d, a, b}, vector<int>{2, 2, 2, 1}, vector<bool>{true, false, false, true})) {
-            spdlog::info("7cut-8 (2221-14) ({}, {}, {}, {}) is dangerous in {}", c, d, a, b, filename);
-        }
-        if (conf.isValid(vector<int>{d, a, b, c}, vector<int>{2, 2, 2, 1}, vector<bool>{true, false, false, true})) {
-            spdlog::info("7cut-8 (2221-14) ({}, {}, {}, {}) is dangerous in {}", d, a, b, c, filename);
-        }
-    }
-
-    // 7cut-9
-    for (auto [a, b]: ab0s) {
-        if (conf.isValid(vector<int>{a, b}, vector<int>{3, 4}, vector<bool>{false, false})) {
-            spdlog::info("7cut-9 (34) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-        if (conf.isValid(vector<int>{a, b}, vector<int>{4, 3}, vector<bool>{false, false})) {
-            spdlog::info("7cut-9 (43) ({}, {}) is dangerous in {}", a, b, filename);
-        }
+    if (result.num_dangerous > 0) {
+        result.stopped = true;
+        return;
     }
 
-    // 7cut-10
-    for (auto [a, b, c]: ab0_ac1_bc1s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{3, 2, 2}, vector<bool>{false, false, false})) {
-            spdlog::info("7cut-10 (322) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-    for (auto [a, b, c]: ab0_ac0_bc0s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 3, 2}, vector<bool>{true, false, false})) {
-            spdlog::info("7cut-10 (232-1) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 3}, vector<bool>{false, true, false})) {
-            spdlog::info("7cut-10 (223-2) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{3, 2, 2}, vector<bool>{false, false, true})) {
-            spdlog::info("7cut-10 (322-3) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
+    // パターンの並び (cut_pattern_loops の番号) を組の大きさの順にする。
+    std::array<size_t, cut_pattern_loops.size()> begins, order;
+    size_t begin = 0;
+    for (size_t l = 0;l < cut_pattern_loops.size(); l++) {
+        begins[l] = begin;
+        order[l] = l;
+        begin += cut_pattern_loops[l].num_patterns;
+    }
+    std::stable_sort(order.begin(), order.end(), [](size_t a, size_t b) {
+        return tuple_families[cut_pattern_loops[a].family].size < tuple_families[cut_pattern_loops[b].family].size;
+    });
+
+    RingTupleIndex index(conf.r_, conf.contractedDistance());
+    std::array<std::optional<std::vector<int>>, NUM_TUPLE_FAMILIES> tuples;
+    std::array<int, MaxRingTupleSize> vs;
+    for (size_t l : order) {
+        const CutPatternLoop &loop = cut_pattern_loops[l];
+        if (!tuples[loop.family]) {
+            ScopedTimer timer(conf.profile(), PhaseTupleIndex);
+            tuples[loop.family] = index.find(tuple_families[loop.family]);
+        }
+        ScopedTimer timer(conf.profile(), PhaseCutPatterns);
+        const std::vector<int> &family = *tuples[loop.family];
+        size_t size = tuple_families[loop.family].size;
+        for (size_t i = 0;i < family.size(); i += size) {
+            for (size_t p = begins[l];p < begins[l] + loop.num_patterns; p++) {
+                if (isDangerousCut(conf, cut_patterns[p], &family[i], vs)) {
+                    reportDangerous(result.num_dangerous, "{} ({}) is dangerous in {}",
+                                    cut_patterns[p].label, fmt::join(vs.begin(), vs.begin() + size, ", "), filename);
+                    result.findings.push_back({cut_patterns[p].label, std::vector<int>(vs.begin(), vs.begin() + size),
+                                               cut_patterns[p].cutSize()});
+                    result.stopped = true;
+                    return;
+                }
+            }
         }
     }
 
-    // 7cut-11
-    for (auto [a, b, c, d]: ab0_cd1s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{3, 1, 2, 1}, vector<bool>{false, false, false, false})) {
-            spdlog::info("7cut-11 (3121) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 3, 1}, vector<bool>{true, false, false, false})) {
-            spdlog::info("7cut-11 (2131-1) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 3, 1}, vector<bool>{false, true, false, false})) {
-            spdlog::info("7cut-11 (2131-2) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{3, 1, 2, 1}, vector<bool>{false, false, true, false})) {
-            spdlog::info("7cut-11 (3121-3) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{3, 1, 2, 1}, vector<bool>{false, false, false, true})) {
-            spdlog::info("7cut-11 (3121-4) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
+    // 7cut-16
+    ScopedTimer timer(conf.profile(), PhaseDegree7);
+    if (!conf.checkDegree7()) {
+        reportDangerous(result.num_dangerous, "7cut-16 (degree 7 in 7-cycle) is dangerous in {}", filename);
+        result.findings.push_back({"7cut-16 (degree 7 in 7-cycle)", {}, 7});
+        result.stopped = true;
     }
+}
 
-    // 7cut-12
-    for (auto [a, b]: ab1s) {
-        if (conf.isValid(vector<int>{a, b}, vector<int>{2, 5}, vector<bool>{false, false})
-            && !conf.forbiddenVertexSize(vector<int>{b, a}, 5, 7)) {
-            spdlog::info("7cut-12 (25) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-        if (conf.isValid(vector<int>{a, b}, vector<int>{5, 2}, vector<bool>{false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, 5, 7)) {
-            spdlog::info("7cut-12 (52) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-    }
-    for (auto [a, b]: ab0s) {
-        if (conf.isValid(vector<int>{a, b}, vector<int>{2, 5}, vector<bool>{true, false})
-            && !conf.forbiddenVertexSize(vector<int>{b, a}, 6, 7)) {
-            spdlog::info("7cut-12 (25-1) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-        if (conf.isValid(vector<int>{a, b}, vector<int>{5, 2}, vector<bool>{true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, 6, 7)) {
-            spdlog::info("7cut-12 (52-1) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-        if (conf.isValid(vector<int>{a, b}, vector<int>{2, 5}, vector<bool>{false, true})
-            && !conf.forbiddenVertexSize(vector<int>{b, a}, 6, 7)) {
-            spdlog::info("7cut-12 (25-2) ({}, {}) is dangerous in {}", a, b, filename);
-        }
-        if (conf.isValid(vector<int>{a, b}, vector<int>{5, 2}, vector<bool>{false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, 6, 7)) {
-            spdlog::info("7cut-12 (52-2) ({}, {}) is dangerous in {}", a, b, filename);
-        }
+// 縮約辺を設定した conf のカットのチェックをする。(filename はログに出力する名前)
+inline CheckResult checkCuts(const Configuration &conf, const std::string &filename, StopPolicy policy) {
+    CheckResult result;
+    if (policy == StopPolicy::FirstDanger) {
+        checkFirstDanger(conf, filename, result);
+    } else {
+        checkAllCuts(conf, filename, result);
     }
+    return result;
+}
 
-    // 7cut-13 
-    for (auto [a, b, c]: ab1_bc1s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 3}, vector<bool>{false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, 3, 7, true)) {
-            spdlog::info("7cut-13 (223) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-    for (auto [a, b, c]: ab0_bc1s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 3}, vector<bool>{true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, 4, 7, true)) {
-            spdlog::info("7cut-13 (223-1) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-    for (auto [a, b, c]: ab1_bc0s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 3}, vector<bool>{false, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, 4, 7, true)) {
-            spdlog::info("7cut-13 (223-3) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-    for (auto [a, b, c]: ab0_ac0_bc0s) {
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{3, 2, 2}, vector<bool>{true, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{b, c, a}, 5, 7, true)) {
-            spdlog::info("7cut-13 (322-12) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 2, 3}, vector<bool>{true, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, 5, 7, true)) {
-            spdlog::info("7cut-13 (223-13) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c}, vector<int>{2, 3, 2}, vector<bool>{false, true, true})
-            && !conf.forbiddenVertexSize(vector<int>{c, a, b}, 5, 7, true)) {
-            spdlog::info("7cut-13 (232-23) ({}, {}, {}) is dangerous in {}", a, b, c, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 3, 2, 0}, vector<bool>{true, false, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 3, 7)) {
-            spdlog::info("7cut-13 (2320-14) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 0, 2, 3}, vector<bool>{false, true, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 3, 7)) {
-            spdlog::info("7cut-13 (2023-23) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
+// 縮約辺を設定した conf のカットのチェックをする。(filename はログに出力する名前)
+// 危険なケースの数を返す。findings が nullptr でなければ危険なケースを加える。
+inline int checkCuts(const Configuration &conf, const std::string &filename, std::vector<Finding> *findings = nullptr) {
+    CheckResult result = checkCuts(conf, filename, StopPolicy::All);
+    if (findings) {
+        findings->insert(findings->end(), result.findings.begin(), result.findings.end());
     }
+    return result.num_dangerous;
+}
 
-    // 7cut-14
-    for (auto [a, b, c, d]: ab1_cd1s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 2, 7)) {
-            spdlog::info("7cut-14 (2221) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{false, false, false, false})
-           && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 2, 7)) {
-            spdlog::info("7cut-14 (2122) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_cd1s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{true, false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 3, 7)) {
-            spdlog::info("7cut-14 (2122-1) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 3, 7)) {
-            spdlog::info("7cut-14 (2221-2) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{true, false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 2, 7)) {
-            spdlog::info("7cut-14 (2221-1) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{false, true, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 2, 7)) {
-            spdlog::info("7cut-14 (2122-2) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{true, false, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 4, 7)) {
-            spdlog::info("7cut-14 (2122-14) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, true, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 1, 4, 7)) {
-            spdlog::info("7cut-14 (2221-23) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{true, false, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 3, 7)) {
-            spdlog::info("7cut-14 (2221-14) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{false, true, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 3, 7)) {
-            spdlog::info("7cut-14 (2122-23) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{true, false, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 3, 7)) {
-            spdlog::info("7cut-14 (2122-13) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, true, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 3, 7)) {
-            spdlog::info("7cut-14 (2221-24) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{true, false, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 3, 7)) {
-            spdlog::info("7cut-14 (2221-13) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 1, 2, 2}, vector<bool>{false, true, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b}, vector<int>{c, d}, 2, 3, 7)) {
-            spdlog::info("7cut-14 (2122-24) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
+// filename の configuration を edgeids の辺で縮約したときのチェックをする。
+// policy が StopPolicy::FirstDanger なら最初の危険なケースで止める。(そのときは頂点ごとの診断も出力しない)
+// cache_dir については loadConfiguration を参照。profile が nullptr でなければ計測結果を加える。
+inline CheckResult check(const std::string &filename, const std::vector<int> &edgeids, StopPolicy policy, Parallelism parallelism = {},
+                  const std::string &cache_dir = "", Profile *profile = nullptr) {
+    ScopedTimer wall(profile);
+    spdlog::info("filename: {}", filename);
+    Configuration conf = [&] {
+        ScopedTimer timer(profile, PhaseLoad);
+        return loadConfiguration(filename, parallelism, cache_dir);
+    }();
+    conf.setProfile(profile);
+    std::vector<std::pair<int, int>> edges = edgeFromId(conf, edgeids);
 
-    // 7cut-15
-    for (auto [a, b, c, d]: ab1_bc1_cd1s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c, d}, 1, 7, true)) {
-            spdlog::info("7cut-15 (2221) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_bc1_cd1s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{true, false, false, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c, d}, 2, 7, true)) {
-            spdlog::info("7cut-15 (2221-1) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab1_bc1_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{false, false, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c, d}, 2, 7, true)) {
-            spdlog::info("7cut-15 (2221-4) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d]: ab0_bc1_cd0s) {
-        if (conf.isValid(vector<int>{a, b, c, d}, vector<int>{2, 2, 2, 1}, vector<bool>{true, false, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c, d}, 3, 7, true)) {
-            spdlog::info("7cut-15 (2221-14) ({}, {}, {}, {}) is dangerous in {}", a, b, c, d, filename);
-        }
-    }
-    for (auto [a, b, c, d, e]: ab1_bc0_de0s) {
-        if (conf.isValid(vector<int>{a, b, c, d, e}, vector<int>{2, 2, 0, 2, 1}, vector<bool>{false, false, true, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, vector<int>{d, e}, 1, 2, 7)) {
-            spdlog::info("7cut-15 (22021-34) ({}, {}, {}, {}, {}) is dangerous in {}", a, b, c, d, e, filename);
-        }
-    }
-    for (auto [a, b, c, d, e]: ab0_bc1_de0s) {
-        if (conf.isValid(vector<int>{a, b, c, d, e}, vector<int>{2, 2, 1, 2, 0}, vector<bool>{true, false, false, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, vector<int>{d, e}, 1, 2, 7)) {
-            spdlog::info("7cut-15 (22120-15) ({}, {}, {}, {}, {}) is dangerous in {}", a, b, c, d, e, filename);
-        }
-    }
-    for (auto [a, b, c, d, e]: ab0_bc0_de0s) {
-        if (conf.isValid(vector<int>{a, b, c, d, e}, vector<int>{2, 2, 1, 2, 0}, vector<bool>{true, false, true, false, true})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, vector<int>{d, e}, 2, 2, 7)) {
-            spdlog::info("7cut-15 (22120-135) ({}, {}, {}, {}, {}) is dangerous in {}", a, b, c, d, e, filename);
-        }
-        if (conf.isValid(vector<int>{a, b, c, d, e}, vector<int>{2, 2, 0, 2, 1}, vector<bool>{true, false, true, true, false})
-            && !conf.forbiddenVertexSize(vector<int>{a, b, c}, vector<int>{d, e}, 2, 2, 7)) {
-            spdlog::info("7cut-15 (22021-134) ({}, {}, {}, {}, {}) is dangerous in {}", a, b, c, d, e, filename);
+    conf.setContract(edges);
+    if (conf.taskPool() != nullptr) {
+        conf.precomputeTables();
+        if (policy == StopPolicy::All) {
+            conf.precomputeReductables();
         }
     }
-
-    // 7cut-16
-    if (!conf.checkDegree7()) {
-        spdlog::info("7cut-16 (degree 7 in 7-cycle) is dangerous in {}", filename);
+    if (policy == StopPolicy::All && diagnosticsEnabled()) {
+        conf.logErasedVertices();
     }
 
-    return;
+    return checkCuts(conf, filename, policy);
 }
 
-
+// filename の configuration を edgeids の辺で縮約したときのチェックをする。
+// 危険なケースの数を返す。
+// cache_dir については loadConfiguration を参照。findings が nullptr でなければ危険なケースを加える。
+// profile が nullptr でなければ計測結果を加える。
+inline int check(const std::string &filename, const std::vector<int> &edgeids, Parallelism parallelism = {}, const std::string &cache_dir = "",
+          std::vector<Finding> *findings = nullptr, Profile *profile = nullptr) {
+    CheckResult result = check(filename, edgeids, StopPolicy::All, parallelism, cache_dir, profile);
+    if (findings) {
+        findings->insert(findings->end(), result.findings.begin(), result.findings.end());
+    }
+    return result.num_dangerous;
+}
@@ -12,10 +12,4 @@ set -euxo pipefail
 confdir=$1
 summary=$2
 
-while IFS="," read f status csize conts; do
-    filename=$(basename $f)
-    conf=${filename%.*}
-    if [ $status = "C" ]; then
-        ./build/a.out -c ${confdir}/${conf}.conf -e $(echo "${conts}" | tr -d '"' | tr '+' ' ')
-    fi
-done < "$summary"
+./build/a.out --summary "${summary}" --confdir "${confdir}"
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <atomic>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fmt/format.h>
+#include "binary_io.hpp"
+
+// 表の計算に関わるソースのハッシュ (CMake が CUT6_BUILD_ID として与える)
+// ソースを変えてビルドし直すと別のキャッシュになる。
+#ifndef CUT6_BUILD_ID
+#define CUT6_BUILD_ID "unknown"
+#endif
+
+// 読み込み専用で mmap したファイル
+class MappedFile {
+  private:
+    void *data_ = nullptr;
+    size_t size_ = 0;
+
+  public:
+    MappedFile() = default;
+
+    // path を mmap する。開けなければ std::runtime_error を投げる。
+    explicit MappedFile(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to stat " + path);
+        }
+        size_ = (size_t)st.st_size;
+        if (size_ > 0) {
+            data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (data_ == MAP_FAILED) {
+            data_ = nullptr;
+            throw std::runtime_error("Failed to mmap " + path);
+        }
+    }
+
+    ~MappedFile() {
+        if (data_ != nullptr) {
+            ::munmap(data_, size_);
+        }
+    }
+
+    MappedFile(MappedFile &&other) noexcept : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const void *data(void) const {
+        return data_;
+    }
+
+    size_t size(void) const {
+        return size_;
+    }
+};
+
+// FNV-1a (64 ビット) ハッシュ
+constexpr uint64_t fnv1a(std::string_view text) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char c : text) {
+        hash ^= (uint8_t)c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// configuration ごとの縮約によらない前計算の結果を置くディレクトリ
+// .conf の内容のハッシュと BuildId をファイル名にするので、内容が変わった .conf や
+// 表の計算を変えたビルドは別のファイルになる。
+// ファイルはヘッダ (マジック, Version, ハッシュ, BuildId, 本体のハッシュ) に続けて本体を並べたもの。
+class ConfCache {
+  private:
+    static constexpr char Magic[8] = {'C', 'U', 'T', '6', 'C', 'A', 'C', 'H'};
+    std::string dir_;
+
+    static constexpr size_t HeaderSize = sizeof(Magic) + 2 * sizeof(uint32_t) + 3 * sizeof(uint64_t);
+    static inline std::atomic<unsigned> temp_counter_ = 0;
+
+  public:
+    // 本体の形式を変えたら上げる。
+    static constexpr uint32_t Version = 2;
+    // 表の計算 (補題の条件) に関わるソースのハッシュ
+    static constexpr uint64_t BuildId = fnv1a(CUT6_BUILD_ID);
+
+    explicit ConfCache(std::string dir) : dir_(std::move(dir)) {}
+
+    std::string path(uint64_t hash) const {
+        return fmt::format("{}/{:016x}-{:016x}.cut6cache", dir_, hash, BuildId);
+    }
+
+    // hash のキャッシュがあれば、それを mmap したファイルを返す。(本体は body で読む)
+    // ファイルがないか、ヘッダが一致しないか、本体が壊れていれば std::nullopt を返す。
+    std::optional<MappedFile> load(uint64_t hash) const {
+        std::string file = path(hash);
+        if (!std::filesystem::exists(file)) {
+            return std::nullopt;
+        }
+        MappedFile mapped(file);
+        BinaryReader reader(mapped.data(), mapped.size());
+        try {
+            for (char c : Magic) {
+                if (reader.read<char>() != c) return std::nullopt;
+            }
+            if (reader.read<uint32_t>() != Version) return std::nullopt;
+            reader.read<uint32_t>();
+            if (reader.read<uint64_t>() != hash) return std::nullopt;
+            if (reader.read<uint64_t>() != BuildId) return std::nullopt;
+            uint64_t body_hash = reader.read<uint64_t>();
+            const char *begin = static_cast<const char *>(mapped.data()) + HeaderSize;
+            if (fnv1a(std::string_view(begin, mapped.size() - HeaderSize)) != body_hash) return std::nullopt;
+        } catch (const std::runtime_error &) {
+            return std::nullopt;
+        }
+        return mapped;
+    }
+
+    // load で返したファイルの本体を読む reader
+    static BinaryReader body(const MappedFile &mapped) {
+        return BinaryReader(static_cast<const uint8_t *>(mapped.data()) + HeaderSize, mapped.size() - HeaderSize);
+    }
+
+    // hash のキャッシュとして本体 body を書き出す。
+    // 一時ファイルに書いてから rename するので、並列に同じファイルを書いても壊れたファイルは読まれない。
+    void store(uint64_t hash, const BinaryWriter &body) const {
+        std::filesystem::create_directories(dir_);
+        std::string file = path(hash);
+        std::string temp = fmt::format("{}.{}.{}.tmp", file, ::getpid(), temp_counter_++);
+        {
+            std::ofstream ofs(temp, std::ios::binary);
+            if (!ofs) {
+                throw std::runtime_error("Failed to open " + temp);
+            }
+            ofs.write(Magic, sizeof(Magic));
+            uint32_t version = Version, reserved = 0;
+            ofs.write(reinterpret_cast<const char *>(&version), sizeof(version));
+            ofs.write(reinterpret_cast<const char *>(&reserved), sizeof(reserved));
+            uint64_t body_hash = fnv1a(body.data()), build_id = BuildId;
+            ofs.write(reinterpret_cast<const char *>(&hash), sizeof(hash));
+            ofs.write(reinterpret_cast<const char *>(&build_id), sizeof(build_id));
+            ofs.write(reinterpret_cast<const char *>(&body_hash), sizeof(body_hash));
+            ofs.write(body.data().data(), (std::streamsize)body.data().size());
+            if (!ofs) {
+                throw std::runtime_error("Failed to write " + temp);
+            }
+        }
+        std::filesystem::rename(temp, file);
+    }
+};
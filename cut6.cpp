@@ -0,0 +1,128 @@
+// cut6_core ライブラリの実装
+// check.hpp などのヘッダのみの実装はこの翻訳単位でだけ include し、cut6.hpp の API で包む。
+#include "cut6.hpp"
+
+#include <sstream>
+#include "check.hpp"
+
+namespace cut6 {
+
+namespace {
+
+::StopPolicy internalPolicy(StopPolicy policy) {
+    return policy == StopPolicy::FirstDanger ? ::StopPolicy::FirstDanger : ::StopPolicy::All;
+}
+
+std::vector<Finding> publicFindings(const std::vector<::Finding> &findings) {
+    std::vector<Finding> result;
+    result.reserve(findings.size());
+    for (const ::Finding &finding : findings) {
+        result.push_back({finding.pattern, finding.tuple, finding.cut_size});
+    }
+    return result;
+}
+
+CheckResult publicResult(const ::CheckResult &result) {
+    return {result.num_dangerous, result.stopped, publicFindings(result.findings)};
+}
+
+std::unique_ptr<ThreadPool> makePool(int jobs) {
+    return jobs > 1 ? std::make_unique<ThreadPool>(jobs) : nullptr;
+}
+
+} // namespace
+
+struct Configuration::Impl {
+    // ログに出力する名前
+    std::string name;
+    // conf の計算に使うスレッドプール (LoadOptions::jobs が 1 なら nullptr)
+    std::unique_ptr<ThreadPool> pool;
+    // 縮約辺を設定していない configuration (contract_ によらない表は計算済み)
+    ::Configuration conf;
+    std::vector<std::pair<int, int>> dual_edges;
+    std::vector<int> edgeids;
+
+    template <typename Load>
+    Impl(std::string name_, int jobs, Load load)
+        : name(std::move(name_)), pool(makePool(jobs)), conf(load(Parallelism{pool.get(), jobs})),
+          dual_edges(dualEdges(conf)) {
+        conf.precomputeTables();
+    }
+};
+
+Configuration::Configuration(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {}
+Configuration::Configuration(Configuration &&) noexcept = default;
+Configuration &Configuration::operator=(Configuration &&) noexcept = default;
+Configuration::~Configuration() = default;
+
+Configuration Configuration::fromFile(const std::string &path, const LoadOptions &options) {
+    return Configuration(std::make_unique<Impl>(path, options.jobs, [&](Parallelism parallelism) {
+        return loadConfiguration(path, parallelism, options.cache_dir);
+    }));
+}
+
+Configuration Configuration::fromBuffer(const std::string &text, const std::string &name, const LoadOptions &options) {
+    return Configuration(std::make_unique<Impl>(name, options.jobs, [&](Parallelism parallelism) {
+        std::istringstream is(text);
+        return ::Configuration::readConf(is, name, parallelism);
+    }));
+}
+
+int Configuration::numVertices(void) const {
+    return impl_->conf.n_;
+}
+
+int Configuration::ringSize(void) const {
+    return impl_->conf.r_;
+}
+
+int Configuration::numEdges(void) const {
+    return (int)impl_->dual_edges.size();
+}
+
+std::pair<int, int> Configuration::edge(int id) const {
+    return impl_->dual_edges.at(id);
+}
+
+void Configuration::setContraction(const std::vector<int> &edgeids) {
+    for (int id : edgeids) {
+        if (id < 0 || id >= numEdges()) {
+            spdlog::critical("Invalid edge id {} in {} (expected 0 <= id < {})", id, impl_->name, numEdges());
+            throw std::runtime_error("Invalid edge id " + std::to_string(id) + " in " + impl_->name);
+        }
+    }
+    impl_->edgeids = edgeids;
+}
+
+const std::vector<int> &Configuration::contraction(void) const {
+    return impl_->edgeids;
+}
+
+CheckResult Configuration::check(StopPolicy policy) const {
+    // 縮約辺ごとのメモを持ち越さないように、縮約前のものを写してから縮約辺を設定する。
+    ::Configuration conf = impl_->conf;
+    conf.setContract(edgeFromId(conf, impl_->edgeids));
+    if (conf.taskPool() != nullptr && policy == StopPolicy::All) {
+        conf.precomputeReductables();
+    }
+    return publicResult(checkCuts(conf, impl_->name, internalPolicy(policy)));
+}
+
+CheckResult check(const std::string &path, const std::vector<int> &edgeids, StopPolicy policy,
+                  const LoadOptions &options) {
+    std::unique_ptr<ThreadPool> pool = makePool(options.jobs);
+    // edgeids の範囲は ::check の中の edgeFromId が調べ、範囲外なら std::runtime_error を投げる。
+    return publicResult(::check(path, edgeids, internalPolicy(policy), Parallelism{pool.get(), options.jobs},
+                                options.cache_dir));
+}
+
+std::string formatFindings(const std::string &file, const std::vector<Finding> &findings) {
+    std::vector<::Finding> internal;
+    internal.reserve(findings.size());
+    for (const Finding &finding : findings) {
+        internal.push_back({finding.pattern, finding.tuple, finding.cut_size});
+    }
+    return ::formatFindings(file, internal);
+}
+
+} // namespace cut6
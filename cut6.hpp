@@ -0,0 +1,95 @@
+#pragma once
+
+// cut6_core ライブラリの公開 API
+// 標準ライブラリ以外のヘッダを含まず、グローバルな名前空間に何も加えないので、
+// 複数の翻訳単位から使ってよい。実装 (check.hpp など) は cut6.cpp の中で 1 度だけコンパイルする。
+// 危険なケースなどのログは spdlog のデフォルトのロガーに出力する。
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cut6 {
+
+// 危険なケース 1 件 (--results の 1 行に対応する)
+struct Finding {
+    // パターンの名前 (例: "7cut-15 (2221-14)")
+    std::string pattern;
+    // カットになりうるリングの頂点の組
+    std::vector<int> tuple;
+    // カットの長さ (6 か 7)
+    int cut_size = 0;
+};
+
+// 危険なケースが見つかったときにチェックを続けるか
+enum class StopPolicy {
+    // 全ての危険なケースを調べる。
+    All,
+    // 最初に見つかった危険なケースで止める。
+    FirstDanger,
+};
+
+// チェックの結果
+struct CheckResult {
+    // 危険なケースの数 (StopPolicy::FirstDanger なら 0 か 1)
+    int num_dangerous = 0;
+    // StopPolicy::FirstDanger で危険なケースが見つかって途中で止めたか
+    bool stopped = false;
+    std::vector<Finding> findings;
+};
+
+// configuration を読み込むときの設定
+struct LoadOptions {
+    // 1 つの configuration の中の計算を分割するタスクの数 (2 以上なら専用のスレッドプールを作る)
+    int jobs = 1;
+    // 前計算の結果を保存するディレクトリ (空なら保存しない、fromFile のときだけ使う)
+    std::string cache_dir;
+};
+
+// 縮約辺を設定してチェックする configuration
+// 異なる Configuration は別々のスレッドで同時にチェックしてよい。
+class Configuration {
+  public:
+    // path の .conf ファイルを読み込む。読み込めなければ std::runtime_error を投げる。
+    static Configuration fromFile(const std::string &path, const LoadOptions &options = {});
+    // .conf の内容 text を読み込む。(name はログに出力する名前)
+    static Configuration fromBuffer(const std::string &text, const std::string &name = "<buffer>",
+                                    const LoadOptions &options = {});
+
+    Configuration(Configuration &&) noexcept;
+    Configuration &operator=(Configuration &&) noexcept;
+    ~Configuration();
+
+    // 頂点数
+    int numVertices(void) const;
+    // リングサイズ
+    int ringSize(void) const;
+    // 双対グラフの辺の数 (id 0, ..., ringSize() - 1 はリングの辺)
+    int numEdges(void) const;
+    // 双対グラフの id の辺に対応する主グラフの辺
+    std::pair<int, int> edge(int id) const;
+
+    // 縮約辺を双対グラフの辺の id (-e と同じもの) で設定する。範囲外の id があれば std::runtime_error を投げる。
+    void setContraction(const std::vector<int> &edgeids);
+    const std::vector<int> &contraction(void) const;
+
+    // 設定した縮約辺でカットのチェックをする。
+    CheckResult check(StopPolicy policy = StopPolicy::All) const;
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+
+    explicit Configuration(std::unique_ptr<Impl> impl);
+};
+
+// path の configuration を edgeids で縮約したときのチェックをする。(main の -c -e と同じ)
+// 読み込めないか、範囲外の id があれば std::runtime_error を投げる。
+CheckResult check(const std::string &path, const std::vector<int> &edgeids, StopPolicy policy = StopPolicy::All,
+                  const LoadOptions &options = {});
+
+// 危険なケースを 1 件 1 行の JSON (--results と同じ形式) にする。
+std::string formatFindings(const std::string &file, const std::vector<Finding> &findings);
+
+} // namespace cut6
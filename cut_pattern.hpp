@@ -0,0 +1,415 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include "ring_tuple_index.hpp"
+
+// 6-cut, 7-cut のパターンで forbiddenVertexSize をどう呼ぶか
+enum class VertexSizeCheck : uint8_t {
+    // 呼ばない
+    None,
+    // forbiddenVertexSize(vs, k1, cutSize, rev)
+    Single,
+    // forbiddenVertexSize(vs1, vs2, k1, k2, cutSize)
+    Pair,
+};
+
+// check で調べる 6-cut, 7-cut のパターン
+// リングの頂点の組 tuple に対して、vs[i] = tuple[order[i]] とおいて isValid(vs, lens, onedge) を調べ、
+// vertex_size が None でなければさらに forbiddenVertexSize を調べる。
+struct CutPattern {
+    // ログに出力するパターンの名前
+    const char *label;
+    // 組の頂点の数
+    size_t size;
+    std::array<size_t, MaxRingTupleSize> order;
+    std::array<int, MaxRingTupleSize> lens;
+    std::array<bool, MaxRingTupleSize> onedge;
+    VertexSizeCheck vertex_size;
+    // Single のとき forbiddenVertexSize に渡す頂点は tuple[vertex_order[0]], ..., tuple[vertex_order[size - 1]]
+    std::array<size_t, MaxRingTupleSize> vertex_order;
+    // Pair のとき vs1 = tuple[0], ..., tuple[split - 1], vs2 = tuple[split], ..., tuple[size - 1]
+    size_t split;
+    int k1, k2;
+    bool rev;
+
+    constexpr int cutSize(void) const {
+        int cut_size = 0;
+        for (size_t i = 0;i < size; i++) {
+            cut_size += lens[i];
+        }
+        return cut_size;
+    }
+
+    constexpr CutPattern single(std::initializer_list<size_t> vs, int k, bool reversed=false) const {
+        CutPattern pattern = *this;
+        pattern.vertex_size = VertexSizeCheck::Single;
+        size_t i = 0;
+        for (size_t v : vs) {
+            pattern.vertex_order[i++] = v;
+        }
+        pattern.k1 = k;
+        pattern.rev = reversed;
+        return pattern;
+    }
+
+    constexpr CutPattern pair(size_t vs1_size, int k1_, int k2_) const {
+        CutPattern pattern = *this;
+        pattern.vertex_size = VertexSizeCheck::Pair;
+        pattern.split = vs1_size;
+        pattern.k1 = k1_;
+        pattern.k2 = k2_;
+        return pattern;
+    }
+};
+
+constexpr CutPattern cutPattern(const char *label, std::initializer_list<size_t> order,
+                                std::initializer_list<int> lens, std::initializer_list<bool> onedge) {
+    CutPattern pattern{label, order.size(), {}, {}, {}, VertexSizeCheck::None, {}, 0, 0, 0, false};
+    size_t i = 0;
+    for (size_t v : order) {
+        pattern.order[i++] = v;
+    }
+    i = 0;
+    for (int l : lens) {
+        pattern.lens[i++] = l;
+    }
+    i = 0;
+    for (bool e : onedge) {
+        pattern.onedge[i++] = e;
+    }
+    return pattern;
+}
+
+// check で調べるリングの頂点の組の族
+// AB0_BC1 は、リングに順に並んでいる頂点 a, b, c であって dist[a][b] = 0, dist[b][c] = 1 であるもの
+// (tuple_families の {3, 2, {{{0, 1, 0}, {1, 2, 1}}}, true})
+enum TupleFamily : uint8_t {
+    AB0,
+    AB1,
+    AB0_BC1,
+    AB1_BC0,
+    AB1_BC1,
+    AB0_AC0_BC0,
+    AB0_AC1_BC1,
+    AB1_AC1_BC1,
+    AB0_CD0,
+    AB0_CD1,
+    AB1_CD1,
+    AB0_BC0_CD0,
+    AB0_BC0_CD1,
+    AB0_BC1_CD0,
+    AB0_BC1_CD1,
+    AB1_BC0_CD0,
+    AB1_BC0_CD1,
+    AB1_BC1_CD0,
+    AB1_BC1_CD1,
+    AB0_BC0_DE0,
+    AB0_BC1_DE0,
+    AB1_BC0_DE0,
+    NUM_TUPLE_FAMILIES
+};
+
+constexpr std::array<RingTupleFamily, NUM_TUPLE_FAMILIES> tuple_families = {{
+    {2, 1, {{{0, 1, 0}}}, false}, // AB0
+    {2, 1, {{{0, 1, 1}}}, false}, // AB1
+    {3, 2, {{{0, 1, 0}, {1, 2, 1}}}, true}, // AB0_BC1
+    {3, 2, {{{0, 1, 1}, {1, 2, 0}}}, true}, // AB1_BC0
+    {3, 2, {{{0, 1, 1}, {1, 2, 1}}}, true}, // AB1_BC1
+    {3, 3, {{{0, 1, 0}, {0, 2, 0}, {1, 2, 0}}}, true}, // AB0_AC0_BC0
+    {3, 3, {{{0, 1, 0}, {0, 2, 1}, {1, 2, 1}}}, true}, // AB0_AC1_BC1
+    {3, 3, {{{0, 1, 1}, {0, 2, 1}, {1, 2, 1}}}, true}, // AB1_AC1_BC1
+    {4, 2, {{{0, 1, 0}, {2, 3, 0}}}, true}, // AB0_CD0
+    {4, 2, {{{0, 1, 0}, {2, 3, 1}}}, true}, // AB0_CD1
+    {4, 2, {{{0, 1, 1}, {2, 3, 1}}}, true}, // AB1_CD1
+    {4, 3, {{{0, 1, 0}, {1, 2, 0}, {2, 3, 0}}}, true}, // AB0_BC0_CD0
+    {4, 3, {{{0, 1, 0}, {1, 2, 0}, {2, 3, 1}}}, true}, // AB0_BC0_CD1
+    {4, 3, {{{0, 1, 0}, {1, 2, 1}, {2, 3, 0}}}, true}, // AB0_BC1_CD0
+    {4, 3, {{{0, 1, 0}, {1, 2, 1}, {2, 3, 1}}}, true}, // AB0_BC1_CD1
+    {4, 3, {{{0, 1, 1}, {1, 2, 0}, {2, 3, 0}}}, true}, // AB1_BC0_CD0
+    {4, 3, {{{0, 1, 1}, {1, 2, 0}, {2, 3, 1}}}, true}, // AB1_BC0_CD1
+    {4, 3, {{{0, 1, 1}, {1, 2, 1}, {2, 3, 0}}}, true}, // AB1_BC1_CD0
+    {4, 3, {{{0, 1, 1}, {1, 2, 1}, {2, 3, 1}}}, true}, // AB1_BC1_CD1
+    {5, 3, {{{0, 1, 0}, {1, 2, 0}, {3, 4, 0}}}, true}, // AB0_BC0_DE0
+    {5, 3, {{{0, 1, 0}, {1, 2, 1}, {3, 4, 0}}}, true}, // AB0_BC1_DE0
+    {5, 3, {{{0, 1, 1}, {1, 2, 0}, {3, 4, 0}}}, true}, // AB1_BC0_DE0
+}};
+
+// check で調べるパターン
+// cut_pattern_loops の順に、各族の組を列挙しながらその族のパターンを順に調べる。
+constexpr std::array<CutPattern, 124> cut_patterns = {{
+    // 6cut-1
+    cutPattern("6cut-1 (24)", {0, 1}, {2, 4}, {false, false}).single({1, 0}, 4),
+    cutPattern("6cut-1 (42)", {0, 1}, {4, 2}, {false, false}).single({0, 1}, 4),
+    // 6cut-2
+    cutPattern("6cut-2 (2121)", {0, 1, 2, 3}, {2, 1, 2, 1}, {false, false, false, false}),
+    // 6cut-3
+    cutPattern("6cut-3 (222)", {0, 1, 2}, {2, 2, 2}, {false, false, false}),
+    // 6cut-4
+    cutPattern("6cut-4 (2121)", {0, 1, 2, 3}, {2, 1, 2, 1}, {false, false, false, false}),
+    cutPattern("6cut-4 (2121-1)", {0, 1, 2, 3}, {2, 1, 2, 1}, {true, false, false, false}),
+    cutPattern("6cut-4 (2121-2)", {0, 1, 2, 3}, {2, 1, 2, 1}, {false, true, false, false}),
+    cutPattern("6cut-4 (2121-3)", {0, 1, 2, 3}, {2, 1, 2, 1}, {false, false, true, false}),
+    cutPattern("6cut-4 (2121-4)", {0, 1, 2, 3}, {2, 1, 2, 1}, {false, false, false, true}),
+    // 6cut-5
+    cutPattern("6cut-5 (222)", {0, 1, 2}, {2, 2, 2}, {false, false, false}),
+    cutPattern("6cut-5 (222-1)", {0, 1, 2}, {2, 2, 2}, {true, false, false}),
+    cutPattern("6cut-5 (222-2)", {0, 1, 2}, {2, 2, 2}, {false, true, false}),
+    cutPattern("6cut-5 (222-3)", {0, 1, 2}, {2, 2, 2}, {false, false, true}),
+    // 6cut-6
+    cutPattern("6cut-6 (33)", {0, 1}, {3, 3}, {false, false}),
+    // 6cut-7
+    cutPattern("6cut-7 (24)", {0, 1}, {2, 4}, {false, false}).single({1, 0}, 4),
+    cutPattern("6cut-7 (42)", {0, 1}, {4, 2}, {false, false}).single({0, 1}, 4),
+    cutPattern("6cut-7 (24-1)", {0, 1}, {2, 4}, {true, false}).single({1, 0}, 5),
+    cutPattern("6cut-7 (42-1)", {0, 1}, {4, 2}, {true, false}).single({0, 1}, 5),
+    cutPattern("6cut-7 (24-2)", {0, 1}, {2, 4}, {false, true}).single({1, 0}, 5),
+    cutPattern("6cut-7 (42-2)", {0, 1}, {4, 2}, {false, true}).single({0, 1}, 5),
+    // 6cut-8
+    cutPattern("6cut-8 (2121)", {0, 1, 2, 3}, {2, 1, 2, 1}, {false, false, false, false}).pair(2, 1, 1),
+    cutPattern("6cut-8 (2121-1)", {0, 1, 2, 3}, {2, 1, 2, 1}, {true, false, false, false}).pair(2, 2, 1),
+    cutPattern("6cut-8 (2121-2)", {0, 1, 2, 3}, {2, 1, 2, 1}, {false, true, false, false}).pair(2, 2, 1),
+    cutPattern("6cut-8 (2121-14)", {0, 1, 2, 3}, {2, 1, 2, 1}, {true, false, false, true}).pair(2, 3, 1),
+    cutPattern("6cut-8 (2121-23)", {0, 1, 2, 3}, {2, 1, 2, 1}, {false, true, true, false}).pair(2, 3, 1),
+    cutPattern("6cut-8 (2121-13)", {0, 1, 2, 3}, {2, 1, 2, 1}, {true, false, true, false}).pair(2, 2, 2),
+    cutPattern("6cut-8 (2121-24)", {0, 1, 2, 3}, {2, 1, 2, 1}, {false, true, false, true}).pair(2, 2, 2),
+    // 6cut-9
+    cutPattern("6cut-9 (222)", {0, 1, 2}, {2, 2, 2}, {false, false, false}).single({0, 1, 2}, 2, true),
+    cutPattern("6cut-9 (222-1)", {0, 1, 2}, {2, 2, 2}, {true, false, false}).single({0, 1, 2}, 3, true),
+    cutPattern("6cut-9 (222-3)", {0, 1, 2}, {2, 2, 2}, {false, false, true}).single({0, 1, 2}, 3, true),
+    cutPattern("6cut-9 (222-13)", {0, 1, 2}, {2, 2, 2}, {true, false, true}).single({0, 1, 2}, 4, true),
+    cutPattern("6cut-9 (222-13)", {1, 2, 0}, {2, 2, 2}, {true, false, true}).single({1, 2, 0}, 4, true),
+    cutPattern("6cut-9 (222-13)", {2, 0, 1}, {2, 2, 2}, {true, false, true}).single({2, 0, 1}, 4, true),
+    cutPattern("6cut-9 (2220-14)", {0, 1, 2, 3}, {2, 2, 2, 0}, {true, false, false, true}).pair(2, 2, 2),
+    cutPattern("6cut-9 (2022-23)", {0, 1, 2, 3}, {2, 0, 2, 2}, {false, true, true, false}).pair(2, 2, 2),
+    // 6cut-10
+    cutPattern("6cut-10 (222)", {0, 1, 2}, {2, 2, 2}, {false, false, false}),
+    cutPattern("6cut-10 (2220-14)", {0, 1, 2, 3}, {2, 2, 2, 0}, {true, false, false, true}),
+    // 7cut-1
+    cutPattern("7cut-1 (25)", {0, 1}, {2, 5}, {false, false}).single({1, 0}, 5),
+    cutPattern("7cut-1 (52)", {0, 1}, {5, 2}, {false, false}).single({0, 1}, 5),
+    // 7cut-2
+    cutPattern("7cut-2 (3121)", {0, 1, 2, 3}, {3, 1, 2, 1}, {false, false, false, false}),
+    cutPattern("7cut-2 (2131)", {0, 1, 2, 3}, {2, 1, 3, 1}, {false, false, false, false}),
+    // 7cut-3
+    cutPattern("7cut-3 (2122)", {0, 1, 2, 3}, {2, 1, 2, 2}, {false, false, false, false}),
+    cutPattern("7cut-3 (2221)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, false, false, false}),
+    // 7cut-4
+    cutPattern("7cut-4 (322)", {0, 1, 2}, {3, 2, 2}, {false, false, false}),
+    cutPattern("7cut-4 (232)", {0, 1, 2}, {2, 3, 2}, {false, false, false}),
+    cutPattern("7cut-4 (223)", {0, 1, 2}, {2, 2, 3}, {false, false, false}),
+    // 7cut-5
+    cutPattern("7cut-5 (223)", {0, 1, 2}, {2, 2, 3}, {false, false, false}).single({0, 1, 2}, 3, true),
+    cutPattern("7cut-5 (223)", {0, 1, 2}, {2, 2, 3}, {false, false, false}).single({0, 1, 2}, 3, true),
+    cutPattern("7cut-5 (223-1)", {0, 1, 2}, {2, 2, 3}, {true, false, false}).single({0, 1, 2}, 4, true),
+    cutPattern("7cut-5 (223-1)", {1, 2, 0}, {2, 2, 3}, {true, false, false}).single({1, 2, 0}, 4, true),
+    cutPattern("7cut-5 (223-1)", {2, 0, 1}, {2, 2, 3}, {true, false, false}).single({2, 0, 1}, 4, true),
+    cutPattern("7cut-5 (223-1)", {0, 1, 2}, {3, 2, 2}, {true, false, false}).single({1, 2, 0}, 4, true),
+    cutPattern("7cut-5 (223-1)", {1, 2, 0}, {3, 2, 2}, {true, false, false}).single({2, 0, 1}, 4, true),
+    cutPattern("7cut-5 (223-1)", {2, 0, 1}, {3, 2, 2}, {true, false, false}).single({0, 1, 2}, 4, true),
+    // 7cut-6
+    cutPattern("7cut-6 (2122)", {0, 1, 2, 3}, {2, 1, 2, 2}, {false, false, false, false}).pair(2, 1, 2),
+    cutPattern("7cut-6 (2221)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, false, false, false}).pair(2, 1, 2),
+    cutPattern("7cut-6 (2122-1)", {0, 1, 2, 3}, {2, 1, 2, 2}, {true, false, false, false}).pair(2, 1, 3),
+    cutPattern("7cut-6 (2221-2)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, true, false, false}).pair(2, 1, 3),
+    cutPattern("7cut-6 (2221-3)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, false, true, false}).pair(2, 1, 3),
+    cutPattern("7cut-6 (2122-4)", {0, 1, 2, 3}, {2, 1, 2, 2}, {false, false, false, true}).pair(2, 1, 3),
+    cutPattern("7cut-6 (2221-1)", {0, 1, 2, 3}, {2, 2, 2, 1}, {true, false, false, false}).pair(2, 2, 2),
+    cutPattern("7cut-6 (2122-2)", {0, 1, 2, 3}, {2, 1, 2, 2}, {false, true, false, false}).pair(2, 2, 2),
+    cutPattern("7cut-6 (2122-3)", {0, 1, 2, 3}, {2, 1, 2, 2}, {false, false, true, false}).pair(2, 2, 2),
+    cutPattern("7cut-6 (2221-4)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, false, false, true}).pair(2, 2, 2),
+    // 7cut-7
+    cutPattern("7cut-7 (2221)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, false, false, false}),
+    cutPattern("7cut-7 (2221)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, false, false, false}),
+    cutPattern("7cut-7 (2221-1)", {0, 1, 2, 3}, {2, 2, 2, 1}, {true, false, false, false}),
+    cutPattern("7cut-7 (2221-4)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, false, false, true}),
+    cutPattern("7cut-7 (22021-34)", {0, 1, 2, 3, 4}, {2, 2, 0, 2, 1}, {false, false, true, true, false}),
+    cutPattern("7cut-7 (22120-15)", {0, 1, 2, 3, 4}, {2, 2, 1, 2, 0}, {true, false, false, false, true}),
+    // 7cut-8
+    cutPattern("7cut-8 (2221)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, false, false, false}),
+    cutPattern("7cut-8 (2221-1)", {0, 1, 2, 3}, {2, 2, 2, 1}, {true, false, false, false}),
+    cutPattern("7cut-8 (2221-4)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, false, false, true}),
+    cutPattern("7cut-8 (2221-14)", {0, 1, 2, 3}, {2, 2, 2, 1}, {true, false, false, true}),
+    cutPattern("7cut-8 (2221-14)", {1, 2, 3, 0}, {2, 2, 2, 1}, {true, false, false, true}),
+    cutPattern("7cut-8 (2221-14)", {2, 3, 0, 1}, {2, 2, 2, 1}, {true, false, false, true}),
+    cutPattern("7cut-8 (2221-14)", {3, 0, 1, 2}, {2, 2, 2, 1}, {true, false, false, true}),
+    // 7cut-9
+    cutPattern("7cut-9 (34)", {0, 1}, {3, 4}, {false, false}),
+    cutPattern("7cut-9 (43)", {0, 1}, {4, 3}, {false, false}),
+    // 7cut-10
+    cutPattern("7cut-10 (322)", {0, 1, 2}, {3, 2, 2}, {false, false, false}),
+    cutPattern("7cut-10 (232-1)", {0, 1, 2}, {2, 3, 2}, {true, false, false}),
+    cutPattern("7cut-10 (223-2)", {0, 1, 2}, {2, 2, 3}, {false, true, false}),
+    cutPattern("7cut-10 (322-3)", {0, 1, 2}, {3, 2, 2}, {false, false, true}),
+    // 7cut-11
+    cutPattern("7cut-11 (3121)", {0, 1, 2, 3}, {3, 1, 2, 1}, {false, false, false, false}),
+    cutPattern("7cut-11 (2131-1)", {0, 1, 2, 3}, {2, 1, 3, 1}, {true, false, false, false}),
+    cutPattern("7cut-11 (2131-2)", {0, 1, 2, 3}, {2, 1, 3, 1}, {false, true, false, false}),
+    cutPattern("7cut-11 (3121-3)", {0, 1, 2, 3}, {3, 1, 2, 1}, {false, false, true, false}),
+    cutPattern("7cut-11 (3121-4)", {0, 1, 2, 3}, {3, 1, 2, 1}, {false, false, false, true}),
+    // 7cut-12
+    cutPattern("7cut-12 (25)", {0, 1}, {2, 5}, {false, false}).single({1, 0}, 5),
+    cutPattern("7cut-12 (52)", {0, 1}, {5, 2}, {false, false}).single({0, 1}, 5),
+    cutPattern("7cut-12 (25-1)", {0, 1}, {2, 5}, {true, false}).single({1, 0}, 6),
+    cutPattern("7cut-12 (52-1)", {0, 1}, {5, 2}, {true, false}).single({0, 1}, 6),
+    cutPattern("7cut-12 (25-2)", {0, 1}, {2, 5}, {false, true}).single({1, 0}, 6),
+    cutPattern("7cut-12 (52-2)", {0, 1}, {5, 2}, {false, true}).single({0, 1}, 6),
+    // 7cut-13
+    cutPattern("7cut-13 (223)", {0, 1, 2}, {2, 2, 3}, {false, false, false}).single({0, 1, 2}, 3, true),
+    cutPattern("7cut-13 (223-1)", {0, 1, 2}, {2, 2, 3}, {true, false, false}).single({0, 1, 2}, 4, true),
+    cutPattern("7cut-13 (223-3)", {0, 1, 2}, {2, 2, 3}, {false, false, true}).single({0, 1, 2}, 4, true),
+    cutPattern("7cut-13 (322-12)", {0, 1, 2}, {3, 2, 2}, {true, true, false}).single({1, 2, 0}, 5, true),
+    cutPattern("7cut-13 (223-13)", {0, 1, 2}, {2, 2, 3}, {true, false, true}).single({0, 1, 2}, 5, true),
+    cutPattern("7cut-13 (232-23)", {0, 1, 2}, {2, 3, 2}, {false, true, true}).single({2, 0, 1}, 5, true),
+    cutPattern("7cut-13 (2320-14)", {0, 1, 2, 3}, {2, 3, 2, 0}, {true, false, false, true}).pair(2, 2, 3),
+    cutPattern("7cut-13 (2023-23)", {0, 1, 2, 3}, {2, 0, 2, 3}, {false, true, true, false}).pair(2, 2, 3),
+    // 7cut-14
+    cutPattern("7cut-14 (2221)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, false, false, false}).pair(2, 1, 2),
+    cutPattern("7cut-14 (2122)", {0, 1, 2, 3}, {2, 1, 2, 2}, {false, false, false, false}).pair(2, 1, 2),
+    cutPattern("7cut-14 (2122-1)", {0, 1, 2, 3}, {2, 1, 2, 2}, {true, false, false, false}).pair(2, 1, 3),
+    cutPattern("7cut-14 (2221-2)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, true, false, false}).pair(2, 1, 3),
+    cutPattern("7cut-14 (2221-1)", {0, 1, 2, 3}, {2, 2, 2, 1}, {true, false, false, false}).pair(2, 2, 2),
+    cutPattern("7cut-14 (2122-2)", {0, 1, 2, 3}, {2, 1, 2, 2}, {false, true, false, false}).pair(2, 2, 2),
+    cutPattern("7cut-14 (2122-14)", {0, 1, 2, 3}, {2, 1, 2, 2}, {true, false, false, true}).pair(2, 1, 4),
+    cutPattern("7cut-14 (2221-23)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, true, true, false}).pair(2, 1, 4),
+    cutPattern("7cut-14 (2221-14)", {0, 1, 2, 3}, {2, 2, 2, 1}, {true, false, false, true}).pair(2, 2, 3),
+    cutPattern("7cut-14 (2122-23)", {0, 1, 2, 3}, {2, 1, 2, 2}, {false, true, true, false}).pair(2, 2, 3),
+    cutPattern("7cut-14 (2122-13)", {0, 1, 2, 3}, {2, 1, 2, 2}, {true, false, true, false}).pair(2, 2, 3),
+    cutPattern("7cut-14 (2221-24)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, true, false, true}).pair(2, 2, 3),
+    cutPattern("7cut-14 (2221-13)", {0, 1, 2, 3}, {2, 2, 2, 1}, {true, false, true, false}).pair(2, 2, 3),
+    cutPattern("7cut-14 (2122-24)", {0, 1, 2, 3}, {2, 1, 2, 2}, {false, true, false, true}).pair(2, 2, 3),
+    // 7cut-15
+    cutPattern("7cut-15 (2221)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, false, false, false}).single({0, 1, 2, 3}, 1, true),
+    cutPattern("7cut-15 (2221-1)", {0, 1, 2, 3}, {2, 2, 2, 1}, {true, false, false, false}).single({0, 1, 2, 3}, 2, true),
+    cutPattern("7cut-15 (2221-4)", {0, 1, 2, 3}, {2, 2, 2, 1}, {false, false, false, true}).single({0, 1, 2, 3}, 2, true),
+    cutPattern("7cut-15 (2221-14)", {0, 1, 2, 3}, {2, 2, 2, 1}, {true, false, false, true}).single({0, 1, 2, 3}, 3, true),
+    cutPattern("7cut-15 (22021-34)", {0, 1, 2, 3, 4}, {2, 2, 0, 2, 1}, {false, false, true, true, false}).pair(3, 1, 2),
+    cutPattern("7cut-15 (22120-15)", {0, 1, 2, 3, 4}, {2, 2, 1, 2, 0}, {true, false, false, false, true}).pair(3, 1, 2),
+    cutPattern("7cut-15 (22120-135)", {0, 1, 2, 3, 4}, {2, 2, 1, 2, 0}, {true, false, true, false, true}).pair(3, 2, 2),
+    cutPattern("7cut-15 (22021-134)", {0, 1, 2, 3, 4}, {2, 2, 0, 2, 1}, {true, false, true, true, false}).pair(3, 2, 2),
+}};
+
+// 族 family の組を列挙しながら、続く num_patterns 個のパターンを順に調べる。
+struct CutPatternLoop {
+    TupleFamily family;
+    size_t num_patterns;
+};
+
+constexpr std::array<CutPatternLoop, 59> cut_pattern_loops = {{
+    // 6cut-1
+    {AB0, 2},
+    // 6cut-2
+    {AB0_CD0, 1},
+    // 6cut-3
+    {AB0_AC0_BC0, 1},
+    // 6cut-4
+    {AB0_CD1, 1},
+    {AB0_CD0, 4},
+    // 6cut-5
+    {AB0_AC1_BC1, 1},
+    {AB0_AC0_BC0, 3},
+    // 6cut-6
+    {AB0, 1},
+    // 6cut-7
+    {AB1, 2},
+    {AB0, 4},
+    // 6cut-8
+    {AB1_CD1, 1},
+    {AB0_CD1, 2},
+    {AB0_CD0, 4},
+    // 6cut-9
+    {AB1_BC1, 1},
+    {AB0_BC1, 1},
+    {AB1_BC0, 1},
+    {AB0_AC0_BC0, 3},
+    {AB0_CD0, 2},
+    // 6cut-10
+    {AB1_AC1_BC1, 1},
+    {AB0_BC1_CD0, 1},
+    // 7cut-1
+    {AB0, 2},
+    // 7cut-2
+    {AB0_CD0, 2},
+    // 7cut-3
+    {AB0_CD0, 2},
+    // 7cut-4
+    {AB0_AC0_BC0, 3},
+    // 7cut-5
+    {AB0_BC1, 1},
+    {AB1_BC0, 1},
+    {AB0_AC0_BC0, 6},
+    // 7cut-6
+    {AB0_CD1, 2},
+    {AB0_CD0, 8},
+    // 7cut-7
+    {AB0_BC1_CD1, 1},
+    {AB1_BC1_CD0, 1},
+    {AB0_BC1_CD0, 2},
+    {AB0_BC0_DE0, 2},
+    // 7cut-8
+    {AB1_BC0_CD1, 1},
+    {AB0_BC0_CD1, 1},
+    {AB1_BC0_CD0, 1},
+    {AB0_BC0_CD0, 4},
+    // 7cut-9
+    {AB0, 2},
+    // 7cut-10
+    {AB0_AC1_BC1, 1},
+    {AB0_AC0_BC0, 3},
+    // 7cut-11
+    {AB0_CD1, 1},
+    {AB0_CD0, 4},
+    // 7cut-12
+    {AB1, 2},
+    {AB0, 4},
+    // 7cut-13
+    {AB1_BC1, 1},
+    {AB0_BC1, 1},
+    {AB1_BC0, 1},
+    {AB0_AC0_BC0, 3},
+    {AB0_CD0, 2},
+    // 7cut-14
+    {AB1_CD1, 2},
+    {AB0_CD1, 4},
+    {AB0_CD0, 8},
+    // 7cut-15
+    {AB1_BC1_CD1, 1},
+    {AB0_BC1_CD1, 1},
+    {AB1_BC1_CD0, 1},
+    {AB0_BC1_CD0, 1},
+    {AB1_BC0_DE0, 1},
+    {AB0_BC1_DE0, 1},
+    {AB0_BC0_DE0, 2},
+}};
+
+// 0, ..., size - 1 の並べ替えか
+constexpr bool isPermutation(const std::array<size_t, MaxRingTupleSize> &order, size_t size) {
+    std::array<bool, MaxRingTupleSize> used{};
+    for (size_t i = 0;i < size; i++) {
+        if (order[i] >= size || used[order[i]]) return false;
+        used[order[i]] = true;
+    }
+    return true;
+}
+
+// 表の整合性を確認する。
+constexpr bool checkCutPatterns(void) {
+    size_t begin = 0;
+    for (const CutPatternLoop &loop : cut_pattern_loops) {
+        if (loop.family >= NUM_TUPLE_FAMILIES) return false;
+        size_t size = tuple_families[loop.family].size;
+        for (size_t p = begin;p < begin + loop.num_patterns; p++) {
+            if (p >= cut_patterns.size()) return false;
+            const CutPattern &pattern = cut_patterns[p];
+            if (pattern.size != size || !isPermutation(pattern.order, size)) return false;
+            if (pattern.cutSize() != 6 && pattern.cutSize() != 7) return false;
+            if (pattern.vertex_size == VertexSizeCheck::Single && !isPermutation(pattern.vertex_order, size)) return false;
+            if (pattern.vertex_size == VertexSizeCheck::Pair && (pattern.split < 2 || size - pattern.split < 2)) return false;
+        }
+        begin += loop.num_patterns;
+    }
+    return begin == cut_patterns.size();
+}
+static_assert(checkCutPatterns());
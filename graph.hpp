@@ -0,0 +1,107 @@
+#pragma once
+
+#include <set>
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include "binary_io.hpp"
+
+// CSR 形式 (offsets + 隣接頂点の配列) の隣接リストと隣接行列 (ビット行列) を持つグラフ
+// 構築後は変更しない。隣接頂点はインデックスの昇順に並んでいる。
+class Graph {
+  private:
+    int n_;
+    // neighbors_[offsets_[v]] ... neighbors_[offsets_[v + 1] - 1] が v の隣接頂点
+    std::vector<int> offsets_;
+    std::vector<uint8_t> neighbors_;
+    // adjacency_[v * words_ + u / 64] の u % 64 ビット目が v から u への辺があるかどうか
+    int words_;
+    std::vector<uint64_t> adjacency_;
+
+    void build(const std::vector<std::set<int>> &VtoV) {
+        offsets_.assign(n_ + 1, 0);
+        for (int v = 0;v < n_; v++) {
+            offsets_[v + 1] = offsets_[v] + (int)VtoV[v].size();
+        }
+        neighbors_.reserve(offsets_[n_]);
+        adjacency_.assign((size_t)n_ * words_, 0);
+        for (int v = 0;v < n_; v++) {
+            for (int u : VtoV[v]) {
+                neighbors_.push_back((uint8_t)u);
+                adjacency_[(size_t)v * words_ + u / 64] |= uint64_t(1) << (u % 64);
+            }
+        }
+    }
+
+  public:
+    // 頂点数の上限 (頂点番号を uint8_t で持つため)
+    static constexpr int MAX_VERTICES = 255;
+
+    Graph() : n_(0), offsets_(1, 0), words_(0) {}
+
+    explicit Graph(const std::vector<std::set<int>> &VtoV) : n_((int)VtoV.size()), words_(((int)VtoV.size() + 63) / 64) {
+        build(VtoV);
+    }
+
+    // edges を無向辺とするグラフ
+    Graph(int n, const std::vector<std::pair<int, int>> &edges) : n_(n), words_((n + 63) / 64) {
+        std::vector<std::set<int>> VtoV(n);
+        for (const auto &e : edges) {
+            VtoV[e.first].insert(e.second);
+            VtoV[e.second].insert(e.first);
+        }
+        build(VtoV);
+    }
+
+    int size(void) const {
+        return n_;
+    }
+
+    std::span<const uint8_t> neighbors(int v) const {
+        return std::span<const uint8_t>(neighbors_.data() + offsets_[v], neighbors_.data() + offsets_[v + 1]);
+    }
+
+    int degree(int v) const {
+        return offsets_[v + 1] - offsets_[v];
+    }
+
+    bool adjacent(int v, int u) const {
+        return (adjacency_[(size_t)v * words_ + u / 64] >> (u % 64)) & 1;
+    }
+
+    void write(BinaryWriter &writer) const {
+        writer.write<int32_t>(n_);
+        writer.writeArray<int>(offsets_);
+        writer.writeArray<uint8_t>(neighbors_);
+    }
+
+    // write で書き出した CSR から隣接行列を作り直す。
+    static Graph read(BinaryReader &reader) {
+        Graph g;
+        g.n_ = reader.read<int32_t>();
+        std::span<const int> offsets = reader.readArray<int>();
+        std::span<const uint8_t> neighbors = reader.readArray<uint8_t>();
+        if (g.n_ < 0 || g.n_ > MAX_VERTICES || offsets.size() != (size_t)g.n_ + 1 ||
+            offsets[0] != 0 || (size_t)offsets[g.n_] != neighbors.size()) {
+            throw std::runtime_error("Invalid graph");
+        }
+        g.words_ = (g.n_ + 63) / 64;
+        g.offsets_.assign(offsets.begin(), offsets.end());
+        g.neighbors_.assign(neighbors.begin(), neighbors.end());
+        g.adjacency_.assign((size_t)g.n_ * g.words_, 0);
+        for (int v = 0;v < g.n_; v++) {
+            if (g.offsets_[v] > g.offsets_[v + 1]) {
+                throw std::runtime_error("Invalid graph");
+            }
+            for (int u : g.neighbors(v)) {
+                if (u >= g.n_) {
+                    throw std::runtime_error("Invalid graph");
+                }
+                g.adjacency_[(size_t)v * g.words_ + u / 64] |= uint64_t(1) << (u % 64);
+            }
+        }
+        return g;
+    }
+};
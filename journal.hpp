@@ -0,0 +1,311 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <sstream>
+#include <deque>
+#include <optional>
+#include <fstream>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdint>
+#include <unistd.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include "results.hpp"
+#include "conf_cache.hpp"
+
+// ジャーナルの 1 行 (チェックし終えた configuration)
+struct JournalRecord {
+    // configuration のファイル名 (JSON のエスケープをしたもの)
+    std::string file;
+    // 縮約辺の id
+    std::vector<int> edgeids;
+    // チェックしたときの StopPolicy の名前 (stopPolicyName)
+    std::string policy;
+    // 危険なケースの数
+    int num_dangerous = 0;
+    // 危険なケースを formatFindings で書いたものの fnv1a ハッシュ
+    uint64_t hash = 0;
+};
+
+inline std::string formatJournalRecord(const JournalRecord &record) {
+    return fmt::format("{{\"file\":\"{}\",\"edgeids\":[{}],\"policy\":\"{}\",\"dangerous\":{},\"hash\":\"{:016x}\"}}\n",
+                       record.file, fmt::join(record.edgeids, ","), record.policy, record.num_dangerous, record.hash);
+}
+
+// formatJournalRecord で書いた行を読む。(途中で切れた行などは std::nullopt)
+inline std::optional<JournalRecord> parseJournalRecord(const std::string &line) {
+    JournalRecord record;
+    try {
+        record.file = resultFile(line);
+        const std::string edgeids = "\",\"edgeids\":[";
+        size_t pos = std::string("{\"file\":\"").size() + record.file.size();
+        if (line.compare(pos, edgeids.size(), edgeids) != 0) return std::nullopt;
+        pos += edgeids.size();
+        size_t end = line.find(']', pos);
+        if (end == std::string::npos) return std::nullopt;
+        std::istringstream ids(line.substr(pos, end - pos));
+        std::string id;
+        while (getline(ids, id, ',')) {
+            record.edgeids.push_back(std::stoi(id));
+        }
+        const std::string policy = "],\"policy\":\"", dangerous = "\",\"dangerous\":", hash = ",\"hash\":\"";
+        if (line.compare(end, policy.size(), policy) != 0) return std::nullopt;
+        size_t policy_end = line.find('"', end + policy.size());
+        if (policy_end == std::string::npos) return std::nullopt;
+        record.policy = line.substr(end + policy.size(), policy_end - end - policy.size());
+        if (line.compare(policy_end, dangerous.size(), dangerous) != 0) return std::nullopt;
+        size_t num_end;
+        record.num_dangerous = std::stoi(line.substr(policy_end + dangerous.size()), &num_end);
+        size_t hash_begin = policy_end + dangerous.size() + num_end;
+        if (line.compare(hash_begin, hash.size(), hash) != 0 || line.size() != hash_begin + hash.size() + 16 + 2 ||
+            line.compare(line.size() - 2, 2, "\"}") != 0) {
+            return std::nullopt;
+        }
+        record.hash = std::stoull(line.substr(hash_begin + hash.size(), 16), nullptr, 16);
+    } catch (const std::exception &) {
+        return std::nullopt;
+    }
+    return record;
+}
+
+// チェックし終えた configuration を記録するジャーナル
+// 記録は 1 つのスレッドで書き出し、SyncRecords 件か SyncInterval ごとにまとめて fsync する。
+// --results のファイルも同じスレッドで書き、ジャーナルより先に fsync するので、
+// ジャーナルにある configuration の危険なケースは必ず --results のファイルにある。
+// 記録は処理し終えた順ではなく index (summary の順番) に書き出す。
+class Journal {
+  private:
+    static constexpr size_t SyncRecords = 64;
+    static constexpr std::chrono::milliseconds SyncInterval{1000};
+
+    std::FILE *journal_ = nullptr;
+    std::FILE *results_ = nullptr;
+    // 再開したときにジャーナルにあった configuration ((file, edgeids) ごと)
+    std::map<std::pair<std::string, std::vector<int>>, JournalRecord> done_;
+    // このチェックの StopPolicy の名前 (違う policy の記録は使わない)
+    std::string policy_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    // (--results に書く行, ジャーナルに書く行)
+    std::deque<std::pair<std::string, std::string>> queue_;
+    // index の順番に並べ直す前の (--results に書く行, ジャーナルに書く行) (記録しない index は空)
+    IndexOrder<std::pair<std::string, std::string>> order_;
+    bool stop_ = false;
+    std::thread thread_;
+
+    static std::FILE *open(const std::string &path, const char *mode) {
+        std::FILE *file = std::fopen(path.c_str(), mode);
+        if (file == nullptr) {
+            spdlog::critical("Failed to open {} ", path);
+            throw std::runtime_error("Failed to open " + path);
+        }
+        return file;
+    }
+
+    static std::vector<std::string> readLines(const std::string &path) {
+        std::vector<std::string> lines;
+        std::ifstream ifs(path);
+        std::string line;
+        while (getline(ifs, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    // path を lines で置き換える。(一時ファイルに書いてから rename する)
+    static void rewrite(const std::string &path, const std::vector<std::string> &lines) {
+        std::string temp = path + ".tmp";
+        std::FILE *file = open(temp, "w");
+        for (const std::string &line : lines) {
+            std::fputs(line.c_str(), file);
+            std::fputc('\n', file);
+        }
+        syncFile(file);
+        std::fclose(file);
+        std::filesystem::rename(temp, path);
+    }
+
+    static void syncFile(std::FILE *file) {
+        if (std::fflush(file) != 0 || ::fsync(fileno(file)) != 0) {
+            spdlog::error("Failed to sync the journal");
+        }
+    }
+
+    void sync(void) {
+        // 危険なケースを先に書き出してから、それを記録したジャーナルを書き出す。
+        if (results_ != nullptr) syncFile(results_);
+        syncFile(journal_);
+    }
+
+    // ジャーナルと --results のファイルを読み、両方に揃っている configuration だけを残す。
+    // 違う policy でチェックして危険なケースがあったものは、危険なケースの数が policy によるので残さない。
+    void load(const std::string &path, const std::string &results_path) {
+        std::vector<std::string> records;
+        for (const std::string &line : readLines(path)) {
+            if (std::optional<JournalRecord> record = parseJournalRecord(line)) {
+                if (record->policy != policy_ && record->num_dangerous > 0) {
+                    spdlog::warn("{} is checked again (it was checked with the stop policy {}, not {})", record->file,
+                                 record->policy, policy_);
+                    done_.erase({record->file, record->edgeids});
+                    continue;
+                }
+                done_[{record->file, record->edgeids}] = *record;
+            } else if (!line.empty()) {
+                spdlog::warn("Ignored a broken line of the journal {}", path);
+            }
+        }
+        if (!results_path.empty()) {
+            // configuration ごとの --results の行
+            std::map<std::string, std::string> texts;
+            std::vector<std::string> order;
+            for (const std::string &line : readLines(results_path)) {
+                try {
+                    std::string file = resultFile(line);
+                    if (!texts.count(file)) order.push_back(file);
+                    texts[file] += line + "\n";
+                } catch (const std::runtime_error &) {
+                    spdlog::warn("Ignored a broken line of {}", results_path);
+                }
+            }
+            for (auto it = done_.begin();it != done_.end();) {
+                if (fnv1a(texts[it->first.first]) != it->second.hash) {
+                    spdlog::warn("{} is checked again (its results do not match the journal)", it->first.first);
+                    it = done_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            std::set<std::string> done_files;
+            for (const auto &[key, record] : done_) {
+                done_files.insert(key.first);
+            }
+            std::vector<std::string> kept;
+            for (const std::string &file : order) {
+                if (!done_files.count(file)) continue;
+                std::istringstream text(texts[file]);
+                std::string line;
+                while (getline(text, line)) {
+                    kept.push_back(line);
+                }
+            }
+            rewrite(results_path, kept);
+        }
+        for (const auto &[key, record] : done_) {
+            std::string line = formatJournalRecord(record);
+            line.pop_back();
+            records.push_back(line);
+        }
+        rewrite(path, records);
+    }
+
+    void writerLoop(void) {
+        std::deque<std::pair<std::string, std::string>> items;
+        size_t pending = 0;
+        auto last_sync = std::chrono::steady_clock::now();
+        while (true) {
+            bool stopping;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait_for(lock, SyncInterval, [&] { return stop_ || !queue_.empty(); });
+                items.swap(queue_);
+                stopping = stop_ && items.empty();
+            }
+            for (const auto &[results, record] : items) {
+                if (results_ != nullptr) {
+                    std::fwrite(results.data(), 1, results.size(), results_);
+                }
+                std::fwrite(record.data(), 1, record.size(), journal_);
+                pending++;
+            }
+            items.clear();
+            auto now = std::chrono::steady_clock::now();
+            if (pending > 0 && (stopping || pending >= SyncRecords || now - last_sync >= SyncInterval)) {
+                sync();
+                pending = 0;
+                last_sync = now;
+            }
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    void push(size_t index, std::pair<std::string, std::string> item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            order_.set(index, std::move(item), [&](std::pair<std::string, std::string> &&ready) {
+                if (!ready.second.empty()) queue_.push_back(std::move(ready));
+            });
+        }
+        cv_.notify_one();
+    }
+
+  public:
+    // path にジャーナルを書く。results_path が空でなければ危険なケースを --results として書く。
+    // resume なら既にあるジャーナルの configuration をチェックし終えたものとし、続けて書く。
+    // (policy (stopPolicyName) と違う policy で危険なケースがあったものはチェックし直す)
+    // size はこの実行で write か skip をする index の数
+    Journal(const std::string &path, const std::string &results_path, bool resume, std::string policy, size_t size)
+        : policy_(std::move(policy)), order_(size) {
+        if (resume && std::filesystem::exists(path)) {
+            load(path, results_path);
+        }
+        bool append = resume && std::filesystem::exists(path);
+        journal_ = open(path, append ? "a" : "w");
+        if (!results_path.empty()) {
+            results_ = open(results_path, append ? "a" : "w");
+        }
+        thread_ = std::thread([this] { writerLoop(); });
+    }
+
+    // キューに残っているものを全て書き出して fsync してから閉じる。
+    ~Journal() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+        if (results_ != nullptr) std::fclose(results_);
+        std::fclose(journal_);
+    }
+
+    Journal(const Journal &) = delete;
+    Journal &operator=(const Journal &) = delete;
+
+    // 再開したときにジャーナルにあった configuration の数
+    size_t numDone(void) const {
+        return done_.size();
+    }
+
+    // file を edgeids で縮約したチェックがジャーナルにあれば、その危険なケースの数を返す。
+    std::optional<int> done(const std::string &file, const std::vector<int> &edgeids) const {
+        auto it = done_.find({jsonEscape(file), edgeids});
+        if (it == done_.end()) {
+            return std::nullopt;
+        }
+        return it->second.num_dangerous;
+    }
+
+    // index 番目の file を edgeids で縮約したチェックを終えたことを記録する。(findings_text は formatFindings の結果)
+    void write(size_t index, const std::string &file, const std::vector<int> &edgeids, int num_dangerous,
+               std::string findings_text) {
+        JournalRecord record{jsonEscape(file), edgeids, policy_, num_dangerous, fnv1a(findings_text)};
+        push(index, {std::move(findings_text), formatJournalRecord(record)});
+    }
+
+    // index 番目を記録しない。(ジャーナルにあったものや失敗したもの)
+    void skip(size_t index) {
+        push(index, {});
+    }
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+// 要素を初めて参照したときに計算して保持する固定長の表
+// 複数のスレッドから同時に get してよい。(clear とコピーは他のスレッドが使っていないときに行う。)
+template <typename T>
+class LazyTable {
+  private:
+    mutable std::vector<T> values_;
+    // ready_[i] := values_[i] が計算済みか
+    std::unique_ptr<std::atomic<bool>[]> ready_;
+    std::unique_ptr<std::mutex> mutex_;
+
+  public:
+    LazyTable() : LazyTable(0) {}
+
+    explicit LazyTable(size_t size) :
+        values_(size),
+        ready_(std::make_unique<std::atomic<bool>[]>(size)),
+        mutex_(std::make_unique<std::mutex>()) {}
+
+    LazyTable(const LazyTable &other) : LazyTable(other.size()) {
+        for (size_t i = 0;i < size(); i++) {
+            if (other.ready_[i].load(std::memory_order_acquire)) {
+                values_[i] = other.values_[i];
+                ready_[i].store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    LazyTable &operator=(const LazyTable &other) {
+        if (this != &other) {
+            *this = LazyTable(other);
+        }
+        return *this;
+    }
+
+    LazyTable(LazyTable &&) = default;
+    LazyTable &operator=(LazyTable &&) = default;
+
+    size_t size(void) const {
+        return values_.size();
+    }
+
+    // i 番目の要素を返す。未計算なら compute() で計算する。
+    // 同時に複数のスレッドが計算することがあるが、最初に計算し終えたものだけを保持する。
+    template <typename F>
+    const T &get(size_t i, F &&compute) const {
+        if (!ready_[i].load(std::memory_order_acquire)) {
+            T value = compute();
+            std::lock_guard<std::mutex> lock(*mutex_);
+            if (!ready_[i].load(std::memory_order_relaxed)) {
+                values_[i] = std::move(value);
+                ready_[i].store(true, std::memory_order_release);
+            }
+        }
+        return values_[i];
+    }
+
+    // i 番目の要素を value にする。(他のスレッドが使っていないときに行う。)
+    void set(size_t i, T value) {
+        values_[i] = std::move(value);
+        ready_[i].store(true, std::memory_order_release);
+    }
+
+    // 全ての要素を未計算に戻す。
+    void clear(void) {
+        for (size_t i = 0;i < size(); i++) {
+            ready_[i].store(false, std::memory_order_relaxed);
+            values_[i] = T();
+        }
+    }
+};
+
+// 要素が bool の LazyTable
+// 各要素を (計算済みか, 値) の 2 ビットで持ち、64 ビットの atomic な語に 32 要素ずつ詰める。
+class LazyBitTable {
+  private:
+    size_t size_;
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+
+    static size_t numWords(size_t size) {
+        return (size + 31) / 32;
+    }
+
+  public:
+    LazyBitTable() : LazyBitTable(0) {}
+
+    explicit LazyBitTable(size_t size) :
+        size_(size),
+        words_(std::make_unique<std::atomic<uint64_t>[]>(numWords(size))) {}
+
+    LazyBitTable(const LazyBitTable &other) : LazyBitTable(other.size_) {
+        for (size_t i = 0;i < numWords(size_); i++) {
+            words_[i].store(other.words_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+    LazyBitTable &operator=(const LazyBitTable &other) {
+        if (this != &other) {
+            *this = LazyBitTable(other);
+        }
+        return *this;
+    }
+
+    LazyBitTable(LazyBitTable &&) = default;
+    LazyBitTable &operator=(LazyBitTable &&) = default;
+
+    size_t size(void) const {
+        return size_;
+    }
+
+    // i 番目の要素を返す。未計算なら compute() で計算する。
+    template <typename F>
+    bool get(size_t i, F &&compute) const {
+        std::atomic<uint64_t> &word = words_[i / 32];
+        int shift = (int)(i % 32) * 2;
+        uint64_t bits = (word.load(std::memory_order_relaxed) >> shift) & 3;
+        if (bits & 1) {
+            return bits >> 1;
+        }
+        bool value = compute();
+        word.fetch_or((uint64_t)(1 | (value << 1)) << shift, std::memory_order_relaxed);
+        return value;
+    }
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/sink.h>
+#include <spdlog/pattern_formatter.h>
+
+// LogCapture が有効なスレッドのログはそのバッファに溜め、それ以外のログは元の sinks に流す sink
+// 並列に処理している configuration ごとにログをまとめて、後から決まった順番で出力するために使う。
+class CaptureSink final : public spdlog::sinks::sink {
+  public:
+    struct Buffer {
+        std::unique_ptr<spdlog::formatter> formatter;
+        std::string text;
+    };
+
+  private:
+    std::vector<spdlog::sink_ptr> sinks_;
+    std::mutex mutex_;
+    std::unique_ptr<spdlog::formatter> formatter_;
+    static inline thread_local Buffer *buffer_ = nullptr;
+
+    friend class LogCapture;
+
+  public:
+    explicit CaptureSink(std::vector<spdlog::sink_ptr> sinks) :
+        sinks_(std::move(sinks)),
+        formatter_(std::make_unique<spdlog::pattern_formatter>()) {}
+
+    void log(const spdlog::details::log_msg &msg) override {
+        if (buffer_ != nullptr) {
+            spdlog::memory_buf_t formatted;
+            buffer_->formatter->format(msg, formatted);
+            buffer_->text.append(formatted.data(), formatted.size());
+            return;
+        }
+        for (auto &sink : sinks_) {
+            if (sink->should_log(msg.level)) {
+                sink->log(msg);
+            }
+        }
+    }
+
+    void flush() override {
+        for (auto &sink : sinks_) {
+            sink->flush();
+        }
+    }
+
+    void set_pattern(const std::string &pattern) override {
+        set_formatter(std::make_unique<spdlog::pattern_formatter>(pattern));
+    }
+
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        formatter_ = std::move(sink_formatter);
+    }
+
+    std::unique_ptr<spdlog::formatter> cloneFormatter(void) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return formatter_->clone();
+    }
+};
+
+// 生存している間、このスレッドのログを CaptureSink のバッファに溜める。
+class LogCapture {
+  private:
+    CaptureSink::Buffer buffer_;
+    CaptureSink::Buffer *previous_;
+
+  public:
+    explicit LogCapture(CaptureSink &sink) : previous_(CaptureSink::buffer_) {
+        buffer_.formatter = sink.cloneFormatter();
+        CaptureSink::buffer_ = &buffer_;
+    }
+
+    ~LogCapture() {
+        CaptureSink::buffer_ = previous_;
+    }
+
+    LogCapture(const LogCapture &) = delete;
+    LogCapture &operator=(const LogCapture &) = delete;
+
+    // 溜まったログを取り出す。
+    std::string take(void) {
+        return std::move(buffer_.text);
+    }
+};
+
+// 生存している間、デフォルトロガーの sink を CaptureSink に置き換える。
+class CaptureLogger {
+  private:
+    std::shared_ptr<spdlog::logger> previous_;
+    std::shared_ptr<CaptureSink> sink_;
+
+  public:
+    CaptureLogger() : previous_(spdlog::default_logger()) {
+        sink_ = std::make_shared<CaptureSink>(previous_->sinks());
+        auto logger = std::make_shared<spdlog::logger>(previous_->name(), sink_);
+        logger->set_level(previous_->level());
+        spdlog::set_default_logger(logger);
+    }
+
+    ~CaptureLogger() {
+        spdlog::set_default_logger(previous_);
+    }
+
+    CaptureLogger(const CaptureLogger &) = delete;
+    CaptureLogger &operator=(const CaptureLogger &) = delete;
+
+    CaptureSink &sink(void) {
+        return *sink_;
+    }
+};
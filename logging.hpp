@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <cstddef>
+#include <cstdlib>
+#include <spdlog/spdlog.h>
+#include <spdlog/async.h>
+
+// 頂点ごとの診断 ("vertex {} is erased by 6" など) を出力するか (--quiet で false にする)
+inline std::atomic<bool> log_diagnostics = true;
+
+// 頂点ごとの診断を出力するか
+inline bool diagnosticsEnabled(void) {
+    return SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO && log_diagnostics.load(std::memory_order_relaxed) &&
+           spdlog::should_log(spdlog::level::info);
+}
+
+// info のログ
+// SPDLOG_ACTIVE_LEVEL が info より大きければ呼び出しごと取り除く。
+// (SPDLOG_INFO と違ってソースの位置を付けないので、出力は spdlog::info と同じ)
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define LOG_INFO(...) spdlog::info(__VA_ARGS__)
+#else
+#define LOG_INFO(...) (void)0
+#endif
+
+// 頂点ごとの診断を info で出力する。
+// SPDLOG_ACTIVE_LEVEL が info より大きければ呼び出しごと取り除き、--quiet なら引数を評価しない。
+#define LOG_DIAGNOSTIC(...) \
+    do { \
+        if (log_diagnostics.load(std::memory_order_relaxed)) { \
+            LOG_INFO(__VA_ARGS__); \
+        } \
+    } while (0)
+
+// 生存している間、デフォルトロガーを同じ sink に書く非同期のロガーに置き換える。
+// ログは大きさが QueueSize のキューに入れて 1 つのスレッドで書き出し、キューが一杯なら空くまで待つ。
+// (CaptureLogger はこのロガーの sink をそのまま使うので、バッチ実行のログの順番は変わらない。)
+class AsyncLogging {
+  private:
+    static constexpr size_t QueueSize = 8192;
+    static inline AsyncLogging *current_ = nullptr;
+    static inline std::terminate_handler previous_terminate_ = nullptr;
+
+    std::shared_ptr<spdlog::logger> previous_;
+    std::shared_ptr<spdlog::details::thread_pool> pool_;
+    std::shared_ptr<spdlog::async_logger> logger_;
+
+    // 元のロガーに戻し、キューに残っているログを書き出してからスレッドを止める。
+    void stop(void) {
+        if (pool_ == nullptr) return;
+        spdlog::set_default_logger(previous_);
+        // スレッドプールを破棄すると、キューに残っているログを書き出してからスレッドを join する。
+        pool_.reset();
+        logger_.reset();
+    }
+
+    // 例外で終了するときにもキューに残っているログを書き出す。
+    [[noreturn]] static void onTerminate(void) {
+        if (current_ != nullptr) {
+            current_->stop();
+        }
+        if (previous_terminate_ != nullptr) {
+            previous_terminate_();
+        }
+        std::abort();
+    }
+
+  public:
+    AsyncLogging() : previous_(spdlog::default_logger()) {
+        pool_ = std::make_shared<spdlog::details::thread_pool>(QueueSize, 1);
+        logger_ = std::make_shared<spdlog::async_logger>(previous_->name(), previous_->sinks().begin(),
+                                                         previous_->sinks().end(), pool_,
+                                                         spdlog::async_overflow_policy::block);
+        logger_->set_level(previous_->level());
+        spdlog::set_default_logger(logger_);
+        current_ = this;
+        previous_terminate_ = std::set_terminate(onTerminate);
+    }
+
+    ~AsyncLogging() {
+        std::set_terminate(previous_terminate_);
+        current_ = nullptr;
+        stop();
+    }
+
+    AsyncLogging(const AsyncLogging &) = delete;
+    AsyncLogging &operator=(const AsyncLogging &) = delete;
+};
@@ -1,19 +1,38 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <thread>
+#include <memory>
 #include <boost/program_options.hpp>
 #include <spdlog/spdlog.h>
-#include "check.hpp"
+#include "batch.hpp"
+#include "search.hpp"
+#include "logging.hpp"
 
 using std::vector;
 using std::string;
 
 int main(const int ac, const char* const* const av) {
+    AsyncLogging async_logging;
     using namespace boost::program_options;
     options_description description("Options");
     description.add_options()
         ("conf,c", value<string>(), "A configuration file")
         ("edgeids,e", value<vector<int>>()->multitoken(), "A list of contraction edge ids (in dual form)")
+        ("summary,s", value<string>(), "A summary file (checks all configurations with status C)")
+        ("confdir,d", value<string>(), "The directory that contains configuration files (with --summary)")
+        ("search-contraction", value<int>(), "Search a contraction of at most N edges with no dangerous case (with -c)")
+        ("results", value<string>(), "A file to write the dangerous cases in JSON Lines (with -c -e or --summary)")
+        ("profile", value<string>(), "A file to write the time of each phase and the counters in JSON, also written as a table in the log (with -c -e or --summary)")
+        ("shard", value<string>(), "Check only the i-th of N shards of the summary (i/N with 0 <= i < N), balanced by the sizes of the configurations (with --summary)")
+        ("merge-results", value<vector<string>>()->multitoken(), "Merge the --results files of shards into the --results file")
+        ("journal", value<string>(), "A file to record the configurations that have been checked (with --summary)")
+        ("resume", "Skip the configurations recorded in the --journal file and continue it")
+        ("first-danger", "Stop checking a configuration at its first dangerous case (with -c -e or --summary)")
+        ("cache-dir", value<string>(), "A directory to keep the precomputed tables of configurations (reused in later runs)")
+        ("jobs,j", value<int>()->default_value((int)std::thread::hardware_concurrency()), "The number of configurations (or contractions with --search-contraction) checked in parallel")
+        ("inner-jobs", value<int>()->default_value(1), "The number of tasks the computation of one configuration is split into (with --summary or --search-contraction, they share the --jobs threads)")
+        ("quiet,q", "Do not write the diagnostics for each vertex (vertex N is erased by 6/7)")
         ("help,H", "Display options")
         ("verbosity,v", value<int>()->default_value(0), "1 for debug, 2 for trace");
 
@@ -34,10 +53,85 @@ int main(const int ac, const char* const* const av) {
             spdlog::set_level(spdlog::level::trace);
         }
     }
-    if (vm.count("conf") && vm.count("edgeids")) {
+    if (vm.count("quiet")) {
+        log_diagnostics = false;
+    }
+    string cache_dir = vm.count("cache-dir") ? vm["cache-dir"].as<string>() : "";
+    if (vm.count("merge-results") && vm.count("results")) {
+        try {
+            mergeResults(vm["merge-results"].as<vector<string>>(), vm["results"].as<string>());
+        } catch (const std::runtime_error &e) {
+            spdlog::error("merge failed ({})", e.what());
+            return 1;
+        }
+    } else if (vm.count("conf") && vm.count("search-contraction")) {
+        SearchOptions options;
+        options.conf = vm["conf"].as<string>();
+        options.max_edges = vm["search-contraction"].as<int>();
+        options.jobs = vm["jobs"].as<int>();
+        options.inner_jobs = vm["inner-jobs"].as<int>();
+        options.cache_dir = cache_dir;
+        if (searchContraction(options).empty()) {
+            return 1;
+        }
+    } else if (vm.count("conf") && vm.count("edgeids")) {
         string conf_file_name = vm["conf"].as<string>();
         vector<int> edgeids = vm["edgeids"].as<vector<int>>();
-        check(conf_file_name, edgeids);
+        int inner_jobs = vm["inner-jobs"].as<int>();
+        std::unique_ptr<ThreadPool> pool;
+        if (inner_jobs > 1) {
+            pool = std::make_unique<ThreadPool>(inner_jobs);
+        }
+        std::unique_ptr<ResultWriter> results;
+        if (vm.count("results")) {
+            results = std::make_unique<ResultWriter>(vm["results"].as<string>(), 1);
+        }
+        Profile profile;
+        bool profiling = vm.count("profile") > 0;
+        ProfileReport report(1);
+        if (profiling) {
+            report.open(vm["profile"].as<string>());
+        }
+        StopPolicy policy = vm.count("first-danger") ? StopPolicy::FirstDanger : StopPolicy::All;
+        CheckResult result = check(conf_file_name, edgeids, policy, Parallelism{pool.get(), inner_jobs}, cache_dir,
+                                   profiling ? &profile : nullptr);
+        if (result.stopped) {
+            spdlog::info("stopped at the first dangerous case");
+        }
+        if (results) {
+            results->write(0, formatFindings(conf_file_name, result.findings));
+        }
+        if (profiling) {
+            report.set(0, conf_file_name, profile.snapshot());
+            report.log();
+            report.write();
+        }
+    } else if (vm.count("summary") && vm.count("confdir")) {
+        BatchOptions options;
+        options.summary = vm["summary"].as<string>();
+        options.confdir = vm["confdir"].as<string>();
+        options.jobs = vm["jobs"].as<int>();
+        options.inner_jobs = vm["inner-jobs"].as<int>();
+        options.cache_dir = cache_dir;
+        if (vm.count("results")) {
+            options.results = vm["results"].as<string>();
+        }
+        if (vm.count("profile")) {
+            options.profile = vm["profile"].as<string>();
+        }
+        if (vm.count("journal")) {
+            options.journal = vm["journal"].as<string>();
+        }
+        options.resume = vm.count("resume") > 0;
+        if (vm.count("first-danger")) {
+            options.stop_policy = StopPolicy::FirstDanger;
+        }
+        if (vm.count("shard")) {
+            options.shard = parseShard(vm["shard"].as<string>());
+        }
+        if (checkAll(options) > 0) {
+            return 1;
+        }
     }
     
     return 0;
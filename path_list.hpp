@@ -0,0 +1,191 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "binary_io.hpp"
+
+// 頂点の列で表したパス
+using Path = std::span<const uint8_t>;
+
+// パスの列
+// 全てのパスの頂点を 1 つの連続した領域に並べて、各パスの開始位置だけを持つ。
+class PathList {
+  private:
+    std::vector<uint8_t> vertices_;
+    // i 番目のパスは vertices_[offsets_[i]] ... vertices_[offsets_[i + 1] - 1]
+    std::vector<uint32_t> offsets_;
+
+  public:
+    class iterator {
+      private:
+        const PathList *list_;
+        size_t index_;
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Path;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Path;
+
+        iterator() : list_(nullptr), index_(0) {}
+        iterator(const PathList *list, size_t index) : list_(list), index_(index) {}
+
+        Path operator*() const {
+            return (*list_)[index_];
+        }
+
+        iterator &operator++() {
+            index_++;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator it = *this;
+            index_++;
+            return it;
+        }
+
+        bool operator==(const iterator &other) const {
+            return index_ == other.index_;
+        }
+    };
+
+    PathList() : offsets_(1, 0) {}
+
+    size_t size(void) const {
+        return offsets_.size() - 1;
+    }
+
+    bool empty(void) const {
+        return size() == 0;
+    }
+
+    Path operator[](size_t i) const {
+        return Path(vertices_.data() + offsets_[i], vertices_.data() + offsets_[i + 1]);
+    }
+
+    iterator begin(void) const {
+        return iterator(this, 0);
+    }
+
+    iterator end(void) const {
+        return iterator(this, size());
+    }
+
+    // 末尾のパスに頂点 v を加える。
+    void pushVertex(int v) {
+        vertices_.push_back((uint8_t)v);
+    }
+
+    // pushVertex で加えてきた頂点を 1 本のパスとして確定する。
+    void closePath(void) {
+        offsets_.push_back((uint32_t)vertices_.size());
+    }
+
+    void push_back(Path path) {
+        vertices_.insert(vertices_.end(), path.begin(), path.end());
+        closePath();
+    }
+
+    void write(BinaryWriter &writer) const {
+        writer.writeArray<uint8_t>(vertices_);
+        writer.writeArray<uint32_t>(offsets_);
+    }
+
+    static PathList read(BinaryReader &reader) {
+        PathList list;
+        std::span<const uint8_t> vertices = reader.readArray<uint8_t>();
+        std::span<const uint32_t> offsets = reader.readArray<uint32_t>();
+        if (offsets.empty() || offsets.front() != 0 || offsets.back() != vertices.size() ||
+            !std::ranges::is_sorted(offsets)) {
+            throw std::runtime_error("Invalid path list");
+        }
+        list.vertices_.assign(vertices.begin(), vertices.end());
+        list.offsets_.assign(offsets.begin(), offsets.end());
+        return list;
+    }
+};
+
+// PathStore に格納するパスごとの前計算した値
+struct PathSummary {
+    // パスの長さ (辺の数)
+    uint8_t length;
+    // パスの辺のうちリングの辺の数
+    uint8_t number_in_ring;
+    // パスによって分けられる頂点集合 (sizeOfVertices) のうちリングの頂点の数
+    uint8_t ring_size;
+    // パスによって分けられる頂点集合 (sizeOfVertices) のうちリングの内側の頂点の数
+    uint8_t inside_size;
+};
+
+// 番号付けされたグループごとのパスの集合
+// 全てのパスの頂点を 1 つの PathList に並べ、グループごとのパスの番号の範囲とパスごとの PathSummary を持つ。
+// グループ 0, 1, ... の順にパスを加えて構築する。
+class PathStore {
+  private:
+    PathList paths_;
+    std::vector<PathSummary> summaries_;
+    // グループ g のパスの番号は group_begin_[g], ..., group_begin_[g + 1] - 1
+    std::vector<uint32_t> group_begin_;
+
+  public:
+    PathStore() : group_begin_(1, 0) {}
+
+    // 構築中のグループにパスを加える。
+    void push_back(Path path, const PathSummary &summary) {
+        paths_.push_back(path);
+        summaries_.push_back(summary);
+    }
+
+    // 構築中のグループを確定する。
+    void closeGroup(void) {
+        group_begin_.push_back((uint32_t)paths_.size());
+    }
+
+    // 確定したグループの数
+    size_t numGroups(void) const {
+        return group_begin_.size() - 1;
+    }
+
+    // グループ g に含まれるパスの番号の範囲
+    auto indices(int g) const {
+        return std::views::iota(group_begin_[g], group_begin_[g + 1]);
+    }
+
+    Path path(size_t i) const {
+        return paths_[i];
+    }
+
+    const PathSummary &summary(size_t i) const {
+        return summaries_[i];
+    }
+
+    void write(BinaryWriter &writer) const {
+        paths_.write(writer);
+        writer.writeArray<PathSummary>(summaries_);
+        writer.writeArray<uint32_t>(group_begin_);
+    }
+
+    static PathStore read(BinaryReader &reader) {
+        static_assert(std::is_trivially_copyable_v<PathSummary>);
+        PathStore store;
+        store.paths_ = PathList::read(reader);
+        std::span<const PathSummary> summaries = reader.readArray<PathSummary>();
+        std::span<const uint32_t> group_begin = reader.readArray<uint32_t>();
+        if (summaries.size() != store.paths_.size() || group_begin.empty() || group_begin.front() != 0 ||
+            group_begin.back() != summaries.size() || !std::ranges::is_sorted(group_begin)) {
+            throw std::runtime_error("Invalid path store");
+        }
+        store.summaries_.assign(summaries.begin(), summaries.end());
+        store.group_begin_.assign(group_begin.begin(), group_begin.end());
+        return store;
+    }
+};
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <string>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include "results.hpp"
+
+// 時間を計る計算の段階
+// 段階は入れ子になることがある。(例えば all_paths は length_tables や reductable_vertices の中で計算される)
+enum ProfilePhase {
+    PhaseLoad,
+    PhaseAllPaths,
+    PhaseLengthTables,
+    PhaseShortestPaths,
+    PhaseCutReduction,
+    PhaseReductableVertices1,
+    PhaseReductableVertices2,
+    PhaseReductableVertices3,
+    PhaseReductableVertices4,
+    PhaseTupleIndex,
+    PhaseContractibleLoop,
+    PhaseCutPatterns,
+    PhaseDegree7,
+    NumProfilePhases
+};
+
+constexpr std::array<const char *, NumProfilePhases> profile_phase_names = {
+    "load", "all_paths", "length_tables", "shortest_paths", "cut_reduction",
+    "reductable_vertices1", "reductable_vertices2", "reductable_vertices3", "reductable_vertices4",
+    "tuple_index", "contractible_loop", "cut_patterns", "degree7",
+};
+
+// 数える事象
+enum ProfileCounter {
+    // shortestPaths の呼び出し
+    CounterShortestPaths,
+    // そのうち最短路を計算したもの (キャッシュになかったもの)
+    CounterShortestPathsComputed,
+    // calculatePaths で列挙したパス
+    CounterEnumeratedPaths,
+    // componentMask (getComponent, sizeOfVertices など) の呼び出し
+    CounterComponents,
+    // checkShortCycle の呼び出しのうちメモにあったもの / なかったもの
+    CounterShortCycleHits,
+    CounterShortCycleMisses,
+    NumProfileCounters
+};
+
+constexpr std::array<const char *, NumProfileCounters> profile_counter_names = {
+    "shortest_paths", "shortest_paths_computed", "enumerated_paths", "components",
+    "short_cycle_hits", "short_cycle_misses",
+};
+
+// 1 つの configuration (またはその合計) の計測結果
+struct ProfileData {
+    // 全体の時間
+    uint64_t wall_nanoseconds = 0;
+    // 段階ごとの時間の合計と回数 (並列に実行した段階はそれぞれの時間を足す)
+    std::array<uint64_t, NumProfilePhases> nanoseconds = {};
+    std::array<uint64_t, NumProfilePhases> calls = {};
+    std::array<uint64_t, NumProfileCounters> counters = {};
+
+    ProfileData &operator+=(const ProfileData &other) {
+        wall_nanoseconds += other.wall_nanoseconds;
+        for (size_t i = 0;i < NumProfilePhases; i++) {
+            nanoseconds[i] += other.nanoseconds[i];
+            calls[i] += other.calls[i];
+        }
+        for (size_t i = 0;i < NumProfileCounters; i++) {
+            counters[i] += other.counters[i];
+        }
+        return *this;
+    }
+};
+
+// 計測結果を溜める。複数のスレッドから同時に加えてよい。
+class Profile {
+  private:
+    std::atomic<uint64_t> wall_nanoseconds_ = 0;
+    std::array<std::atomic<uint64_t>, NumProfilePhases> nanoseconds_ = {};
+    std::array<std::atomic<uint64_t>, NumProfilePhases> calls_ = {};
+    std::array<std::atomic<uint64_t>, NumProfileCounters> counters_ = {};
+
+  public:
+    void addWall(uint64_t nanoseconds) {
+        wall_nanoseconds_.fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+
+    void addPhase(ProfilePhase phase, uint64_t nanoseconds) {
+        nanoseconds_[phase].fetch_add(nanoseconds, std::memory_order_relaxed);
+        calls_[phase].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void count(ProfileCounter counter, uint64_t n = 1) {
+        counters_[counter].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    ProfileData snapshot(void) const {
+        ProfileData data;
+        data.wall_nanoseconds = wall_nanoseconds_.load(std::memory_order_relaxed);
+        for (size_t i = 0;i < NumProfilePhases; i++) {
+            data.nanoseconds[i] = nanoseconds_[i].load(std::memory_order_relaxed);
+            data.calls[i] = calls_[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0;i < NumProfileCounters; i++) {
+            data.counters[i] = counters_[i].load(std::memory_order_relaxed);
+        }
+        return data;
+    }
+};
+
+// profile が nullptr でなければ profile->count(counter, n) を呼ぶ。
+inline void profileCount(Profile *profile, ProfileCounter counter, uint64_t n = 1) {
+    if (profile != nullptr) {
+        profile->count(counter, n);
+    }
+}
+
+// 生存している間の時間 (経過時間) を profile の phase (phase を省略したら全体の時間) に加える。
+// profile が nullptr なら何もしない。
+// TaskGroup::wait は待っている間にスレッドプールの他のタスクを実行するので、
+// 複数の configuration が 1 つのスレッドプールを共有していると、その時間には他の configuration のタスクも含まれる。
+class ScopedTimer {
+  private:
+    using Clock = std::chrono::steady_clock;
+    Profile *profile_;
+    ProfilePhase phase_;
+    Clock::time_point start_;
+
+  public:
+    explicit ScopedTimer(Profile *profile, ProfilePhase phase = NumProfilePhases) : profile_(profile), phase_(phase) {
+        if (profile_ != nullptr) {
+            start_ = Clock::now();
+        }
+    }
+
+    ~ScopedTimer() {
+        if (profile_ == nullptr) return;
+        if (phase_ == NumProfilePhases) {
+            profile_->addWall(elapsed());
+        } else {
+            profile_->addPhase(phase_, elapsed());
+        }
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    uint64_t elapsed(void) const {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_).count();
+    }
+};
+
+// configuration ごとの計測結果の一覧
+class ProfileReport {
+  private:
+    std::vector<std::string> files_;
+    std::vector<ProfileData> data_;
+    // open で開いた書き出し先
+    std::FILE *file_ = nullptr;
+    // 時間に他の configuration のタスクが含まれうるか (ScopedTimer を参照)
+    bool includes_helped_tasks_ = false;
+
+    static double milliseconds(uint64_t nanoseconds) {
+        return (double)nanoseconds / 1e6;
+    }
+
+    // data の JSON のメンバ (ファイル名以外)
+    static std::string jsonMembers(const ProfileData &data) {
+        std::string text = fmt::format("\"wall_ms\":{:.3f},\"phases\":{{", milliseconds(data.wall_nanoseconds));
+        for (size_t i = 0;i < NumProfilePhases; i++) {
+            fmt::format_to(std::back_inserter(text), "{}\"{}\":{{\"ms\":{:.3f},\"calls\":{}}}", i == 0 ? "" : ",",
+                           profile_phase_names[i], milliseconds(data.nanoseconds[i]), data.calls[i]);
+        }
+        text += "},\"counters\":{";
+        for (size_t i = 0;i < NumProfileCounters; i++) {
+            fmt::format_to(std::back_inserter(text), "{}\"{}\":{}", i == 0 ? "" : ",", profile_counter_names[i],
+                           data.counters[i]);
+        }
+        text += "}";
+        return text;
+    }
+
+  public:
+    explicit ProfileReport(size_t size = 0) : files_(size), data_(size) {}
+
+    ~ProfileReport() {
+        if (file_ != nullptr) std::fclose(file_);
+    }
+
+    ProfileReport(const ProfileReport &) = delete;
+    ProfileReport &operator=(const ProfileReport &) = delete;
+
+    // 時間に TaskGroup::wait の間に実行した他の configuration のタスクが含まれうることを記録する。
+    // (ログと JSON にそのことを出力する)
+    void setIncludesHelpedTasks(bool includes) {
+        includes_helped_tasks_ = includes;
+    }
+
+    // json() の書き出し先 path を開く。(計測の前に開いておき、書き出せないことを先に知らせる)
+    void open(const std::string &path) {
+        file_ = std::fopen(path.c_str(), "w");
+        if (file_ == nullptr) {
+            spdlog::critical("Failed to open {} ", path);
+            throw std::runtime_error("Failed to open " + path);
+        }
+    }
+
+    size_t size(void) const {
+        return data_.size();
+    }
+
+    // index 番目の configuration の結果を設定する。(異なる index なら並列に設定してよい)
+    void set(size_t index, std::string file, const ProfileData &data) {
+        files_[index] = std::move(file);
+        data_[index] = data;
+    }
+
+    ProfileData total(void) const {
+        ProfileData total;
+        for (const ProfileData &data : data_) {
+            total += data;
+        }
+        return total;
+    }
+
+    // 段階ごとの合計と、時間のかかった configuration の上位 top 件を表にしてログに出力する。
+    void log(size_t top = 10) const {
+        if (data_.empty()) return;
+        ProfileData sum = total();
+        spdlog::info("profile of {} configurations (wall {:.1f} ms)", data_.size(), milliseconds(sum.wall_nanoseconds));
+        if (includes_helped_tasks_) {
+            spdlog::info("the times are wall times including the tasks of other configurations run while waiting (--inner-jobs > 1)");
+        }
+        spdlog::info("{:<22} {:>10} {:>12} {:>8} {:>12}  {}", "phase", "calls", "total ms", "share", "max ms", "max in");
+        for (size_t i = 0;i < NumProfilePhases; i++) {
+            size_t argmax = 0;
+            for (size_t j = 0;j < data_.size(); j++) {
+                if (data_[j].nanoseconds[i] > data_[argmax].nanoseconds[i]) argmax = j;
+            }
+            double share = sum.wall_nanoseconds == 0 ? 0.0 : 100.0 * sum.nanoseconds[i] / sum.wall_nanoseconds;
+            spdlog::info("{:<22} {:>10} {:>12.3f} {:>7.1f}% {:>12.3f}  {}", profile_phase_names[i], sum.calls[i],
+                         milliseconds(sum.nanoseconds[i]), share, milliseconds(data_[argmax].nanoseconds[i]),
+                         files_[argmax]);
+        }
+        spdlog::info("{:<22} {:>14} {:>14}  {}", "counter", "total", "max", "max in");
+        for (size_t i = 0;i < NumProfileCounters; i++) {
+            size_t argmax = 0;
+            for (size_t j = 0;j < data_.size(); j++) {
+                if (data_[j].counters[i] > data_[argmax].counters[i]) argmax = j;
+            }
+            spdlog::info("{:<22} {:>14} {:>14}  {}", profile_counter_names[i], sum.counters[i],
+                         data_[argmax].counters[i], files_[argmax]);
+        }
+        if (data_.size() == 1) return;
+
+        std::vector<size_t> order(data_.size());
+        for (size_t j = 0;j < order.size(); j++) order[j] = j;
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return data_[a].wall_nanoseconds > data_[b].wall_nanoseconds;
+        });
+        order.resize(std::min(order.size(), top));
+        spdlog::info("slowest {} configurations:", order.size());
+        for (size_t j : order) {
+            const ProfileData &data = data_[j];
+            size_t slowest = std::max_element(data.nanoseconds.begin() + PhaseAllPaths, data.nanoseconds.end()) -
+                             data.nanoseconds.begin();
+            spdlog::info("{:>12.3f} ms  {} (slowest phase: {} {:.3f} ms)", milliseconds(data.wall_nanoseconds), files_[j],
+                         profile_phase_names[slowest], milliseconds(data.nanoseconds[slowest]));
+        }
+    }
+
+    // configuration ごとの結果と合計を JSON にする。
+    std::string json(void) const {
+        std::string text = fmt::format("{{\"includes_helped_tasks\":{},\"configurations\":[", includes_helped_tasks_);
+        for (size_t j = 0;j < data_.size(); j++) {
+            fmt::format_to(std::back_inserter(text), "{}\n{{\"file\":\"{}\",{}}}", j == 0 ? "" : ",",
+                           jsonEscape(files_[j]), jsonMembers(data_[j]));
+        }
+        fmt::format_to(std::back_inserter(text), "\n],\n\"total\":{{{}}}}}\n", jsonMembers(total()));
+        return text;
+    }
+
+    // json() を open で開いたファイルに書き出して閉じる。
+    void write(void) {
+        if (file_ == nullptr) return;
+        std::string text = json();
+        std::fwrite(text.data(), 1, text.size(), file_);
+        if (std::fclose(file_) != 0) {
+            spdlog::error("Failed to write the profile");
+        }
+        file_ = nullptr;
+    }
+};
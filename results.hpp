@@ -0,0 +1,166 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <iterator>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <stdexcept>
+#include <cstdio>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+// check で見つかった危険なケース
+struct Finding {
+    // パターンの名前 (例: "7cut-15 (2221-14)")
+    std::string pattern;
+    // カットになりうるリングの頂点の組
+    std::vector<int> tuple;
+    // カットの長さ (6 か 7)
+    int cut_size;
+};
+
+// JSON の文字列に埋め込めるようにエスケープする。
+inline std::string jsonEscape(std::string_view text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+        case '"': escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\r': escaped += "\\r"; break;
+        case '\t': escaped += "\\t"; break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                escaped += fmt::format("\\u{:04x}", (int)(unsigned char)c);
+            } else {
+                escaped += c;
+            }
+        }
+    }
+    return escaped;
+}
+
+// file の configuration の findings を 1 件 1 行の JSON (JSON Lines) にする。
+inline std::string formatFindings(const std::string &file, const std::vector<Finding> &findings) {
+    std::string text;
+    std::string escaped_file = jsonEscape(file);
+    for (const Finding &finding : findings) {
+        fmt::format_to(std::back_inserter(text), "{{\"file\":\"{}\",\"pattern\":\"{}\",\"tuple\":[{}],\"cut_size\":{}}}\n",
+                       escaped_file, jsonEscape(finding.pattern), fmt::join(finding.tuple, ","), finding.cut_size);
+    }
+    return text;
+}
+
+// --results の 1 行の "file" の値 (エスケープされたまま)
+inline std::string resultFile(const std::string &line) {
+    const std::string prefix = "{\"file\":\"";
+    if (line.compare(0, prefix.size(), prefix) != 0) {
+        throw std::runtime_error("Invalid result line: " + line);
+    }
+    size_t end = prefix.size();
+    while (end < line.size() && line[end] != '"') {
+        end += line[end] == '\\' ? 2 : 1;
+    }
+    if (end >= line.size()) {
+        throw std::runtime_error("Invalid result line: " + line);
+    }
+    return line.substr(prefix.size(), end - prefix.size());
+}
+
+// 並列に処理した結果を index の順番に並べ直す。(排他は呼ぶ側でする)
+template <typename T>
+class IndexOrder {
+  private:
+    std::vector<T> items_;
+    std::vector<bool> done_;
+    size_t next_ = 0;
+
+  public:
+    explicit IndexOrder(size_t size = 0) : items_(size), done_(size, false) {}
+
+    // index 番目の結果を設定し、そこまでの結果が揃っていれば順に emit に渡す。
+    template <typename Emit>
+    void set(size_t index, T item, Emit &&emit) {
+        items_[index] = std::move(item);
+        done_[index] = true;
+        while (next_ < done_.size() && done_[next_]) {
+            emit(std::move(items_[next_]));
+            items_[next_] = T();
+            next_++;
+        }
+    }
+};
+
+// 結果を 1 つのスレッドでファイルに書き出す。
+// write は文字列をキューに入れるだけなので、並列に処理しているスレッドはファイルへの書き込みを待たない。
+// 結果は処理し終えた順ではなく index の順番に書き出す。(前の index の結果が揃うまでメモリに溜めておく)
+class ResultWriter {
+  private:
+    std::FILE *file_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::string> queue_;
+    IndexOrder<std::string> order_;
+    bool stop_ = false;
+    std::thread thread_;
+
+    void writerLoop(void) {
+        std::deque<std::string> texts;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+                if (queue_.empty()) {
+                    return;
+                }
+                texts.swap(queue_);
+            }
+            for (const std::string &text : texts) {
+                std::fwrite(text.data(), 1, text.size(), file_);
+            }
+            texts.clear();
+        }
+    }
+
+  public:
+    // path に size 個の結果 (index 0, ..., size - 1) を書き出す。
+    ResultWriter(const std::string &path, size_t size) : file_(std::fopen(path.c_str(), "w")), order_(size) {
+        if (file_ == nullptr) {
+            spdlog::critical("Failed to open {} ", path);
+            throw std::runtime_error("Failed to open " + path);
+        }
+        thread_ = std::thread([this] { writerLoop(); });
+    }
+
+    // キューに残っているものを全て書き出してから閉じる。
+    ~ResultWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+        if (std::ferror(file_)) {
+            spdlog::error("Failed to write the results");
+        }
+        std::fclose(file_);
+    }
+
+    ResultWriter(const ResultWriter &) = delete;
+    ResultWriter &operator=(const ResultWriter &) = delete;
+
+    // index 番目の結果を書き出す。(結果のない index も空の text で書き出す)
+    void write(size_t index, std::string text) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            order_.set(index, std::move(text), [&](std::string &&ready) {
+                if (!ready.empty()) queue_.push_back(std::move(ready));
+            });
+        }
+        cv_.notify_one();
+    }
+};
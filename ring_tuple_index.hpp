@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include "byte_matrix.hpp"
+
+// リングの頂点の組 (a, b) に対する縮約後の距離の条件 dist[a][b] = d
+// a, b は組の中での位置
+struct RingDistanceConstraint {
+    size_t a, b;
+    int d;
+};
+
+// 列挙するリングの頂点の組の大きさの最大値
+constexpr size_t MaxRingTupleSize = 5;
+
+// リングに順に並んでいる size 個の頂点の組であって、constraints[0], ..., constraints[num_constraints - 1] を
+// 全て満たすものの族 (cyclic については RingTupleIndex::find を参照)
+struct RingTupleFamily {
+    size_t size;
+    size_t num_constraints;
+    std::array<RingDistanceConstraint, 3> constraints;
+    bool cyclic;
+};
+
+// 縮約後の距離が 0, 1 であるリングの頂点の組の索引
+// リングに順に並んでいる頂点の組であって、指定した位置の頂点間の距離が指定した値であるものを列挙する。
+class RingTupleIndex {
+  private:
+    int r_;
+    // dist_[a][b] := リングの頂点 a, b の縮約後の距離
+    ByteMatrix dist_;
+    // near_[d][a] := 縮約後の距離が d であるリングの頂点 (a 以外) を昇順に並べたもの
+    std::array<std::vector<std::vector<int>>, 2> near_;
+    // 0, 1, ..., r - 1
+    std::vector<int> all_;
+
+    // a から見たリング上の位置
+    int offset(int a, int v) const {
+        return (v - a + r_) % r_;
+    }
+
+    // tuple[0], ..., tuple[i - 1] が決まっているときに、残りの頂点を選んで条件を満たす組を全て emit に渡す。
+    template <typename F>
+    void extend(std::array<int, MaxRingTupleSize> &tuple, size_t k, size_t i,
+                std::span<const RingDistanceConstraint> constraints, bool cyclic, F &&emit) const {
+        if (i == k) {
+            emit(tuple);
+            return;
+        }
+        // tuple[i] の候補は、それより前の位置の頂点との条件があればその頂点の near_ から、なければ全ての頂点から選ぶ。
+        const std::vector<int> *candidates = &all_;
+        for (const auto &c : constraints) {
+            if (c.b == i && c.a < i) {
+                candidates = &near_[c.d][tuple[c.a]];
+                break;
+            }
+        }
+        for (int v : *candidates) {
+            if (i > 0) {
+                if (cyclic ? offset(tuple[0], v) <= offset(tuple[0], tuple[i - 1]) : v <= tuple[i - 1]) {
+                    continue;
+                }
+            }
+            bool ok = true;
+            for (const auto &c : constraints) {
+                if (c.b == i && c.a < i && dist_[tuple[c.a]][v] != c.d) {
+                    ok = false;
+                    break;
+                }
+            }
+            if (!ok) continue;
+            tuple[i] = v;
+            extend(tuple, k, i + 1, constraints, cyclic, emit);
+        }
+        return;
+    }
+
+    static void checkConstraints(size_t k, std::span<const RingDistanceConstraint> constraints) {
+        assert(k <= MaxRingTupleSize);
+        for ([[maybe_unused]] const auto &c : constraints) {
+            assert(c.a < c.b && c.b < k);
+            assert(c.d == 0 || c.d == 1);
+        }
+    }
+
+  public:
+    RingTupleIndex(int r, const ByteMatrix &contract_dist) : r_(r), dist_(r, r), all_(r) {
+        for (int d = 0;d < 2; d++) {
+            near_[d].assign(r, {});
+        }
+        for (int a = 0;a < r; a++) {
+            all_[a] = a;
+            for (int b = 0;b < r; b++) {
+                dist_[a][b] = contract_dist[a][b];
+                if (a != b && contract_dist[a][b] < 2) {
+                    near_[contract_dist[a][b]][a].push_back(b);
+                }
+            }
+        }
+    }
+
+    // family の組を辞書順に列挙し、組の頂点を順に連結した列として返す。
+    // 各条件は a < b で、d は 0 か 1 とする。
+    // cyclic = false のときは組の頂点のインデックスが昇順であるもの (リングを 0 で切った列の上で順に並んでいるもの) だけを列挙する。
+    std::vector<int> find(const RingTupleFamily &family) const {
+        std::span<const RingDistanceConstraint> constraints(family.constraints.data(), family.num_constraints);
+        checkConstraints(family.size, constraints);
+        std::vector<int> tuples;
+        std::array<int, MaxRingTupleSize> tuple{};
+        extend(tuple, family.size, 0, constraints, family.cyclic, [&] (const std::array<int, MaxRingTupleSize> &t) {
+            tuples.insert(tuples.end(), t.begin(), t.begin() + family.size);
+        });
+        return tuples;
+    }
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+#include "check.hpp"
+#include "thread_pool.hpp"
+#include "log_capture.hpp"
+
+// 縮約辺の探索の設定
+struct SearchOptions {
+    std::string conf;
+    // 縮約辺の数の最大値
+    int max_edges = 1;
+    // 並列にチェックする候補の数
+    int jobs = 1;
+    // 1 つの候補の中の計算を分割するタスクの数 (同じスレッドプールで実行する)
+    int inner_jobs = 1;
+    // 前計算の結果を保存するディレクトリ (空なら保存しない)
+    std::string cache_dir;
+};
+
+// 縮約辺の候補 (双対グラフの辺の id の集合) のうち大きさ size のものを辞書順に列挙し、
+// 候補ごとにその縮約辺を設定した probe で visit(edgeids, probe) を呼ぶ。visit が false を返したら止める。
+// リング以外の辺の id を昇順に選んでいき、canHaveContractibleLoop で危険なケースがある集合とそれを含む集合は除く。
+// (辺を加えると縮約後の距離は短くなるだけで、length6_, length7_ と checkShortCycle は縮約によらないので、
+//  canHaveContractibleLoop の危険なケースは減らない。)
+// probe は最後に加えた辺から順に除くので、縮約後の状態は addContractEdge の前に戻すだけで済む。
+// 最後まで列挙したら true を返す。
+template <typename Visit>
+bool forEachContractionCandidate(Configuration &probe, const std::vector<std::pair<int, int>> &edges, int size, Visit &&visit) {
+    std::vector<int> edgeids;
+    auto extend = [&] (auto &&self, int next) -> bool {
+        for (int id = next;id < (int)edges.size(); id++) {
+            edgeids.push_back(id);
+            probe.addContractEdge(edges[id].first, edges[id].second);
+            bool ok = true;
+            if (probe.canHaveContractibleLoop(nullptr, StopPolicy::FirstDanger) == 0) {
+                ok = (int)edgeids.size() == size ? visit(std::as_const(edgeids), std::as_const(probe)) : self(self, id + 1);
+            }
+            edgeids.pop_back();
+            probe.removeContractEdge(edges[id].first, edges[id].second);
+            if (!ok) return false;
+        }
+        return true;
+    };
+    return extend(extend, probe.r_);
+}
+
+// options.conf の configuration を縮約したときに危険なケースがなくなる縮約辺を探す。
+// 大きさ 1, ..., max_edges の順に、同じ大きさなら辞書順で最初に見つかった縮約辺の id を返す。見つからなければ空を返す。
+// 候補は大きさごとに列挙しながら並列にチェックし、見つかったらそれより後の候補は列挙しない。
+inline std::vector<int> searchContraction(const SearchOptions &options) {
+    spdlog::info("filename: {}", options.conf);
+    std::vector<int> found;
+    {
+        CaptureLogger capture_logger;
+        ThreadPool pool(options.jobs);
+        Configuration conf = loadConfiguration(options.conf, Parallelism{&pool, options.inner_jobs}, options.cache_dir);
+        // contract_ によらない表は全ての候補で共通なので、コピーする前に計算しておく。
+        conf.precomputeTables();
+        std::vector<std::pair<int, int>> edges = dualEdges(conf);
+        Configuration probe = conf;
+
+        // 一度にチェックする候補の数 (候補ごとに Configuration をコピーするので、列挙しすぎないようにする)
+        const size_t ChunkSize = 4 * (size_t)std::max(options.jobs, 1);
+        std::vector<std::vector<int>> chunk_edgeids;
+        std::vector<Configuration> chunk;
+        chunk.reserve(ChunkSize);
+        // chunk をチェックし、縮約辺が見つかったら found に入れる。
+        auto checkChunk = [&] {
+            std::atomic<size_t> first = chunk.size();
+            TaskGroup group(&pool);
+            for (size_t i = 0;i < chunk.size(); i++) {
+                group.run([&, i] {
+                    if (first.load() < i) return;
+                    LogCapture capture(capture_logger.sink());
+                    if (checkCuts(chunk[i], options.conf, StopPolicy::FirstDanger).num_dangerous == 0) {
+                        size_t current = first.load();
+                        while (i < current && !first.compare_exchange_weak(current, i)) {}
+                    }
+                });
+            }
+            group.wait();
+            if (first < chunk.size()) {
+                found = chunk_edgeids[first];
+            }
+            chunk.clear();
+            chunk_edgeids.clear();
+        };
+
+        for (int size = 1;size <= options.max_edges && found.empty(); size++) {
+            size_t num_candidates = 0;
+            {
+                LogCapture capture(capture_logger.sink());
+                forEachContractionCandidate(probe, edges, size, [&](const std::vector<int> &edgeids, const Configuration &candidate) {
+                    num_candidates++;
+                    chunk_edgeids.push_back(edgeids);
+                    chunk.push_back(candidate);
+                    if (chunk.size() == ChunkSize) {
+                        checkChunk();
+                    }
+                    return found.empty();
+                });
+                if (found.empty()) {
+                    checkChunk();
+                }
+            }
+            spdlog::info("{} candidates of {} edges", num_candidates, size);
+        }
+    }
+    if (found.empty()) {
+        spdlog::info("no contraction found in {}", options.conf);
+        return {};
+    }
+    spdlog::info("contraction found in {}: -e {}", options.conf, fmt::join(found, " "));
+    return found;
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include "results.hpp"
+
+// summary の configuration を N 個に分けたうちの index 番目 (0 <= index < count)
+struct Shard {
+    int index = 0;
+    int count = 1;
+};
+
+// "i/N" を Shard にする。
+inline Shard parseShard(const std::string &text) {
+    size_t slash = text.find('/');
+    Shard shard;
+    try {
+        if (slash == std::string::npos) throw std::invalid_argument(text);
+        size_t pos;
+        shard.index = std::stoi(text.substr(0, slash), &pos);
+        if (pos != slash) throw std::invalid_argument(text);
+        shard.count = std::stoi(text.substr(slash + 1), &pos);
+        if (pos != text.size() - slash - 1) throw std::invalid_argument(text);
+    } catch (const std::logic_error &) {
+        spdlog::critical("Invalid shard {} (expected i/N)", text);
+        throw std::runtime_error("Invalid shard " + text + " (expected i/N)");
+    }
+    if (shard.count < 1 || shard.index < 0 || shard.index >= shard.count) {
+        spdlog::critical("Invalid shard {} (expected 0 <= i < N)", text);
+        throw std::runtime_error("Invalid shard " + text + " (expected 0 <= i < N)");
+    }
+    return shard;
+}
+
+// .conf のヘッダ (2 行目の頂点数 n とリングサイズ r) から見積もったチェックの重さ
+// 長さ 7 以下のパスをリングの頂点の組ごとに列挙するのが重いので r^2 n とする。
+// ヘッダを読めなければ 1 とする。(チェックするときに失敗する)
+inline double confCost(const std::string &filename) {
+    std::ifstream ifs(filename);
+    std::string name;
+    int n, r;
+    if (!getline(ifs, name) || !(ifs >> n >> r) || n <= 0 || r <= 0) {
+        return 1.0;
+    }
+    return (double)r * r * n;
+}
+
+// 重さ costs[i] の configuration を shard.count 個に分けて、shard.index 番目のものの番号を昇順に返す。
+// 重い順に (同じなら番号の順に) その時点で合計が最も軽い (同じなら番号が最小の) shard に入れるので、
+// 同じ costs と shard.count なら常に同じ分け方になる。
+inline std::vector<size_t> shardIndices(const std::vector<double> &costs, const Shard &shard) {
+    std::vector<size_t> order(costs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return costs[a] > costs[b];
+    });
+    std::vector<double> load(shard.count, 0.0);
+    std::vector<size_t> indices;
+    for (size_t i : order) {
+        int lightest = (int)(std::min_element(load.begin(), load.end()) - load.begin());
+        load[lightest] += costs[i];
+        if (lightest == shard.index) indices.push_back(i);
+    }
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+// --results のファイル results に対応するマニフェストのパス
+// マニフェストはチェックし終えたときに書き、どの shard のどの configuration をチェックしたかを記録する。
+// 1 行目は {"shard":"i/N","configurations":K}、続く K 行は {"file":"...","dangerous":n}
+// (n は危険なケースの数、読み込みに失敗したら -1)
+inline std::string manifestPath(const std::string &results) {
+    return results + ".manifest";
+}
+
+// マニフェストの内容
+struct ShardManifest {
+    Shard shard;
+    // (configuration のファイル名 (JSON のエスケープをしたもの), 危険なケースの数)
+    std::vector<std::pair<std::string, int>> files;
+};
+
+// "{prefix}整数}" の形の line の整数を読む。読めなければ std::nullopt を返す。
+inline std::optional<int> manifestNumber(const std::string &line, size_t pos, const std::string &prefix) {
+    if (line.compare(pos, prefix.size(), prefix) != 0 || line.empty() || line.back() != '}') return std::nullopt;
+    pos += prefix.size();
+    try {
+        size_t end;
+        int value = std::stoi(line.substr(pos), &end);
+        if (pos + end != line.size() - 1) return std::nullopt;
+        return value;
+    } catch (const std::logic_error &) {
+        return std::nullopt;
+    }
+}
+
+// マニフェストを一時ファイルに書いてから path に rename する。
+inline void writeManifest(const std::string &path, const ShardManifest &manifest) {
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream ofs(temp);
+        ofs << fmt::format("{{\"shard\":\"{}/{}\",\"configurations\":{}}}\n", manifest.shard.index, manifest.shard.count,
+                           manifest.files.size());
+        for (const auto &[file, num_dangerous] : manifest.files) {
+            ofs << fmt::format("{{\"file\":\"{}\",\"dangerous\":{}}}\n", file, num_dangerous);
+        }
+        if (!ofs) {
+            spdlog::critical("Failed to write {} ", temp);
+            throw std::runtime_error("Failed to write " + temp);
+        }
+    }
+    std::filesystem::rename(temp, path);
+}
+
+// マニフェストを読む。ないか壊れていれば (その shard が終わっていないので) std::runtime_error を投げる。
+inline ShardManifest readManifest(const std::string &path) {
+    auto invalid = [&](const std::string &reason) {
+        spdlog::critical("{} {} (the shard has not finished?)", reason, path);
+        return std::runtime_error(reason + " " + path);
+    };
+    std::ifstream ifs(path);
+    if (!ifs) {
+        throw invalid("No manifest");
+    }
+    ShardManifest manifest;
+    std::string line;
+    const std::string shard_prefix = "{\"shard\":\"";
+    if (!getline(ifs, line) || line.compare(0, shard_prefix.size(), shard_prefix) != 0) {
+        throw invalid("Invalid manifest");
+    }
+    size_t end = line.find('"', shard_prefix.size());
+    if (end == std::string::npos) {
+        throw invalid("Invalid manifest");
+    }
+    manifest.shard = parseShard(line.substr(shard_prefix.size(), end - shard_prefix.size()));
+    std::optional<int> count = manifestNumber(line, end, "\",\"configurations\":");
+    if (!count) {
+        throw invalid("Invalid manifest");
+    }
+    while (getline(ifs, line)) {
+        std::string file;
+        try {
+            file = resultFile(line);
+        } catch (const std::runtime_error &) {
+            throw invalid("Invalid manifest");
+        }
+        std::optional<int> num_dangerous = manifestNumber(line, std::string("{\"file\":\"").size() + file.size(), "\",\"dangerous\":");
+        if (!num_dangerous) {
+            throw invalid("Invalid manifest");
+        }
+        manifest.files.emplace_back(file, *num_dangerous);
+    }
+    if ((int)manifest.files.size() != *count) {
+        throw invalid("Truncated manifest");
+    }
+    return manifest;
+}
+
+// shard ごとの --results のファイル inputs を 1 つにまとめて output に書き出す。
+// 行は configuration のファイル名の順に並べ、同じ configuration の行は元の順番のままにする。
+// 入力ごとのマニフェストを読み、0/N, ..., (N-1)/N の shard が 1 つずつ揃っていて、
+// configuration が 1 つの shard にだけあり、読み込みに失敗したものがなく、危険なケースの行の数が
+// マニフェストと一致するときだけ書き出す。(そうでなければ std::runtime_error を投げる)
+// output のマニフェスト (0/1) も書く。まとめた危険なケースの数を返す。
+inline size_t mergeResults(const std::vector<std::string> &inputs, const std::string &output) {
+    auto fail = [](const std::string &message) {
+        spdlog::critical("{}", message);
+        return std::runtime_error(message);
+    };
+    // configuration ごとの (入力の番号, 危険なケースの数)
+    std::map<std::string, std::pair<size_t, int>> configurations;
+    std::vector<int> shard_inputs;
+    for (size_t k = 0;k < inputs.size(); k++) {
+        ShardManifest manifest = readManifest(manifestPath(inputs[k]));
+        if (k == 0) {
+            shard_inputs.assign(manifest.shard.count, -1);
+        } else if (manifest.shard.count != (int)shard_inputs.size()) {
+            throw fail(fmt::format("{} is a shard of {}, but {} is a shard of {}", inputs[k], manifest.shard.count,
+                                   inputs[0], shard_inputs.size()));
+        }
+        int &input = shard_inputs[manifest.shard.index];
+        if (input >= 0) {
+            throw fail(fmt::format("shard {}/{} appears in both {} and {}", manifest.shard.index, manifest.shard.count,
+                                   inputs[input], inputs[k]));
+        }
+        input = (int)k;
+        for (const auto &[file, num_dangerous] : manifest.files) {
+            auto [it, inserted] = configurations.try_emplace(file, k, num_dangerous);
+            if (!inserted) {
+                throw fail(fmt::format("{} appears in both {} and {}", file, inputs[it->second.first], inputs[k]));
+            }
+            if (num_dangerous < 0) {
+                throw fail(fmt::format("{} failed in {}", file, inputs[k]));
+            }
+        }
+    }
+    for (size_t i = 0;i < shard_inputs.size(); i++) {
+        if (shard_inputs[i] < 0) {
+            throw fail(fmt::format("shard {}/{} is missing", i, shard_inputs.size()));
+        }
+    }
+
+    // configuration ごとの行
+    std::map<std::string, std::vector<std::string>> lines;
+    for (size_t k = 0;k < inputs.size(); k++) {
+        std::ifstream ifs(inputs[k]);
+        if (!ifs) {
+            spdlog::critical("Failed to open {} ", inputs[k]);
+            throw std::runtime_error("Failed to open " + inputs[k]);
+        }
+        std::string line;
+        while (getline(ifs, line)) {
+            if (line.empty()) continue;
+            std::string file = resultFile(line);
+            auto it = configurations.find(file);
+            if (it == configurations.end() || it->second.first != k) {
+                throw fail(fmt::format("{} in {} is not in its manifest", file, inputs[k]));
+            }
+            lines[file].push_back(line);
+        }
+    }
+    ShardManifest merged;
+    for (const auto &[file, entry] : configurations) {
+        size_t num_lines = lines.count(file) ? lines[file].size() : 0;
+        if ((int)num_lines != entry.second) {
+            throw fail(fmt::format("{} has {} dangerous cases in the manifest of {}, but {} in the file", file,
+                                   entry.second, inputs[entry.first], num_lines));
+        }
+        merged.files.emplace_back(file, entry.second);
+    }
+
+    std::ofstream ofs(output);
+    size_t num_lines = 0;
+    for (const auto &[file, entry] : lines) {
+        for (const std::string &line : entry) {
+            ofs << line << '\n';
+            num_lines++;
+        }
+    }
+    ofs.close();
+    if (!ofs) {
+        spdlog::critical("Failed to write {} ", output);
+        throw std::runtime_error("Failed to write " + output);
+    }
+    writeManifest(manifestPath(output), merged);
+    spdlog::info("merged {} dangerous cases of {} configurations from {} shards into {}", num_lines,
+                 configurations.size(), inputs.size(), output);
+    return num_lines;
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <condition_variable>
+
+// work stealing をするスレッドプール
+// 各ワーカーは自分のキューの末尾からタスクを取り出し、空になったら他のワーカーのキューの先頭から盗む。
+class ThreadPool {
+  private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    // キューに入っているタスクの数
+    std::atomic<int> pending_ = 0;
+    std::atomic<unsigned> next_queue_ = 0;
+    bool stop_ = false;
+    // 現在のスレッドがワーカーならそのプールとインデックス
+    static inline thread_local const ThreadPool *current_pool_ = nullptr;
+    static inline thread_local int current_index_ = -1;
+
+    bool popBack(Queue &queue, std::function<void()> &task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        pending_--;
+        return true;
+    }
+
+    bool popFront(Queue &queue, std::function<void()> &task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        pending_--;
+        return true;
+    }
+
+    // self のキュー、他のキューの順にタスクを探す。(self = -1 ならワーカー以外)
+    bool pop(int self, std::function<void()> &task) {
+        if (self >= 0 && popBack(*queues_[self], task)) {
+            return true;
+        }
+        int n = size();
+        for (int k = 1;k <= n; k++) {
+            int i = (self + k + n) % n;
+            if (i != self && popFront(*queues_[i], task)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(int index) {
+        current_pool_ = this;
+        current_index_ = index;
+        while (true) {
+            std::function<void()> task;
+            if (pop(index, task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&] { return stop_ || pending_ > 0; });
+            if (stop_ && pending_ == 0) {
+                return;
+            }
+        }
+    }
+
+  public:
+    explicit ThreadPool(int num_threads) {
+        if (num_threads < 1) num_threads = 1;
+        for (int i = 0;i < num_threads; i++) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (int i = 0;i < num_threads; i++) {
+            workers_.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const {
+        return (int)queues_.size();
+    }
+
+    // 現在のスレッドがこのプールのワーカーかどうか
+    bool isWorkerThread() const {
+        return current_pool_ == this;
+    }
+
+    // タスクを追加する。
+    // ワーカーから追加したタスクはそのワーカーのキューに、それ以外は順番に各キューに入れる。
+    void submit(std::function<void()> task) {
+        int i = isWorkerThread() ? current_index_ : (int)(next_queue_++ % queues_.size());
+        {
+            std::lock_guard<std::mutex> lock(queues_[i]->mutex);
+            queues_[i]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_++;
+        }
+        cv_.notify_one();
+    }
+
+    // キューにあるタスクを 1 つ実行する。実行するタスクがなければ false を返す。
+    bool runPendingTask() {
+        std::function<void()> task;
+        if (!pop(isWorkerThread() ? current_index_ : -1, task)) {
+            return false;
+        }
+        task();
+        return true;
+    }
+};
+
+// まとめて完了を待つタスクの集合
+// pool が nullptr ならタスクはその場で実行される。
+// ワーカーの中で wait() するとデッドロックしないように他のタスクを実行しながら待つ。
+class TaskGroup {
+  private:
+    ThreadPool *pool_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<int> pending_ = 0;
+    std::exception_ptr error_;
+
+    void finish(void) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pending_ == 0) {
+            cv_.notify_all();
+        }
+    }
+
+  public:
+    explicit TaskGroup(ThreadPool *pool) : pool_(pool) {}
+
+    ~TaskGroup() {
+        try {
+            wait();
+        } catch (...) {
+        }
+    }
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    void run(std::function<void()> task) {
+        pending_++;
+        auto wrapped = [this, task = std::move(task)] {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+            finish();
+        };
+        if (pool_ == nullptr) {
+            wrapped();
+        } else {
+            pool_->submit(std::move(wrapped));
+        }
+    }
+
+    // 全てのタスクが終わるまで待つ。タスクが例外を投げていたら最初の例外を投げ直す。
+    void wait(void) {
+        if (pool_ != nullptr && pool_->isWorkerThread()) {
+            while (pending_ > 0) {
+                if (!pool_->runPendingTask()) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return pending_ == 0; });
+        if (error_) {
+            std::exception_ptr error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+// begin <= i < end の各 i について f(i, task) を呼ぶ。
+// i は num_tasks 個のタスクに動的に割り振り、pool で並列に実行する。task (0 <= task < num_tasks) は f を呼んでいるタスクの番号。
+// pool が nullptr か num_tasks <= 1 ならその場で順番に実行する。
+template <typename F>
+void parallelFor(ThreadPool *pool, int num_tasks, int begin, int end, F &&f) {
+    if (pool == nullptr || num_tasks <= 1 || end - begin <= 1) {
+        for (int i = begin;i < end; i++) {
+            f(i, 0);
+        }
+        return;
+    }
+    std::atomic<int> next = begin;
+    TaskGroup group(pool);
+    for (int task = 0;task < num_tasks && task < end - begin; task++) {
+        group.run([&, task] {
+            for (int i = next++;i < end;i = next++) {
+                f(i, task);
+            }
+        });
+    }
+    group.wait();
+}
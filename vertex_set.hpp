@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include "graph.hpp"
+
+// 高々 MaxN 頂点の集合を表す固定長のビット集合
+template <int MaxN>
+class BitSet {
+  private:
+    static constexpr int WORDS = (MaxN + 63) / 64;
+    std::array<uint64_t, WORDS> words_{};
+
+  public:
+    void set(int v) {
+        words_[v / 64] |= uint64_t(1) << (v % 64);
+    }
+
+    void reset(int v) {
+        words_[v / 64] &= ~(uint64_t(1) << (v % 64));
+    }
+
+    bool test(int v) const {
+        return (words_[v / 64] >> (v % 64)) & 1;
+    }
+
+    bool any(void) const {
+        for (uint64_t w : words_) {
+            if (w) return true;
+        }
+        return false;
+    }
+
+    bool none(void) const {
+        return !any();
+    }
+
+    int count(void) const {
+        int c = 0;
+        for (uint64_t w : words_) {
+            c += std::popcount(w);
+        }
+        return c;
+    }
+
+    // 最小の要素 (空なら -1)
+    int first(void) const {
+        for (int i = 0;i < WORDS; i++) {
+            if (words_[i]) return i * 64 + std::countr_zero(words_[i]);
+        }
+        return -1;
+    }
+
+    // 要素を昇順に f に渡す。
+    template <typename F>
+    void forEach(F &&f) const {
+        for (int i = 0;i < WORDS; i++) {
+            uint64_t w = words_[i];
+            while (w) {
+                f(i * 64 + std::countr_zero(w));
+                w &= w - 1;
+            }
+        }
+    }
+
+    BitSet &operator|=(const BitSet &other) {
+        for (int i = 0;i < WORDS; i++) words_[i] |= other.words_[i];
+        return *this;
+    }
+
+    BitSet &operator&=(const BitSet &other) {
+        for (int i = 0;i < WORDS; i++) words_[i] &= other.words_[i];
+        return *this;
+    }
+
+    // 差集合
+    BitSet &operator-=(const BitSet &other) {
+        for (int i = 0;i < WORDS; i++) words_[i] &= ~other.words_[i];
+        return *this;
+    }
+
+    // 対称差
+    BitSet &operator^=(const BitSet &other) {
+        for (int i = 0;i < WORDS; i++) words_[i] ^= other.words_[i];
+        return *this;
+    }
+
+    friend BitSet operator|(BitSet a, const BitSet &b) {
+        return a |= b;
+    }
+
+    friend BitSet operator&(BitSet a, const BitSet &b) {
+        return a &= b;
+    }
+
+    friend BitSet operator-(BitSet a, const BitSet &b) {
+        return a -= b;
+    }
+
+    friend BitSet operator^(BitSet a, const BitSet &b) {
+        return a ^= b;
+    }
+
+    bool operator==(const BitSet &other) const = default;
+
+    // {0, 1, ..., n - 1}
+    static BitSet range(int n) {
+        BitSet s;
+        for (int i = 0;i < WORDS; i++) {
+            int lo = i * 64;
+            if (n >= lo + 64) {
+                s.words_[i] = ~uint64_t(0);
+            } else if (n > lo) {
+                s.words_[i] = (uint64_t(1) << (n - lo)) - 1;
+            }
+        }
+        return s;
+    }
+};
+
+using VertexSet = BitSet<Graph::MAX_VERTICES + 1>;